@@ -1,6 +1,7 @@
 #ifndef SunRise_h
 #define SunRise_h
 
+#include <stdint.h>
 #include <time.h>
 
 // Size of event search window in hours.
@@ -10,7 +11,92 @@
 // windows will increase interpolation error.  Useful values are probably from
 // 12 - 48 but will depend upon your application.
 
+#ifndef SR_WINDOW
 #define SR_WINDOW   48	    // Even integer
+#endif
+
+// Interval in minutes between tests of the sun's altitude within the window.
+// It must be even and divide the window.  Shorter steps follow the sun's
+// altitude more closely at a higher cost; extras/sunriseTune measures the
+// choices for an application.
+#ifndef SR_STEP
+#define SR_STEP	    60
+#endif
+
+// Number of evenly spaced points in the window at which the sun's position is
+// evaluated and interpolated.  Two interpolate linearly; three, fitted by a
+// quadratic, follow the sun well over two days.
+#ifndef SR_POINTS
+#define SR_POINTS   3
+#endif
+
+// Interval in minutes between tests of the sun's altitude against terrain on
+// the horizon, while the sun is within the terrain's range of altitude.  It
+// must divide the step.  Peaks that hide the sun for less than this may be
+// missed.
+#ifndef SR_MASK_STEP
+#define SR_MASK_STEP	2
+#endif
+
+// Events of the same type closer together than this many seconds are taken
+// to be one event found twice, by searches from nearby times with slightly
+// different interpolation errors.
+#ifndef SR_EVENT_GUARD
+#define SR_EVENT_GUARD	120
+#endif
+
+// Compact form of the SunRise results, for keeping large tables in memory.
+// Event times are held as signed second offsets from the query time, which
+// must lie between 1970 and 2106, and azimuths in hundredths of a degree.
+// Sixteen bytes, against forty for the SunRise class on 64-bit hosts.
+struct SunRisePacked {
+  uint32_t queryTime;
+  int32_t riseOffset : 20;	    // Seconds from queryTime.
+  uint32_t hasRise : 1;
+  uint32_t hasSet : 1;
+  uint32_t isVisible : 1;
+  int32_t setOffset : 20;
+  uint16_t riseAz;		    // Hundredths of a degree.
+  uint16_t setAz;
+};
+
+#if SR_WINDOW / 2 * 3600 >= (1L << 19)
+#error "SR_WINDOW too large for SunRisePacked offsets"
+#endif
+
+// A sun rise or set event, as listed by SunRiseKernel::events().
+struct SunRiseEvent {
+  time_t time;
+  float azimuth;
+  bool rise;			    // Otherwise a set.
+};
+
+// Observer position at a time, for calculating events along a track.
+struct SunRiseFix {
+  time_t time;
+  double latitude;
+  double longitude;
+};
+
+// The altitude of the terrain on the horizon in degrees, at count evenly
+// spaced azimuths starting at north and going through east, for calculating
+// when the sun clears it.
+struct SunRiseHorizonMask {
+  const float *altitude;
+  int count;
+};
+
+// The observer's height in metres above a level horizon (the sea, or a
+// plain), and the air pressure in millibars and temperature in degrees
+// Celsius, which set the dip of the horizon and the refraction at it.  The
+// standard conditions assumed otherwise are 0 metres, 1010 millibars and 10
+// degrees.  A pressure of 0, as left by { height } alone, stands for the
+// standard pressure and temperature.
+struct SunRiseConditions {
+  double height;
+  double pressure;
+  double temperature;
+};
 
 class SunRise {
   public:
@@ -24,14 +110,16 @@ class SunRise {
     bool isVisible;
 
     void calculate(double latitude, double longitude, time_t t);
+    void calculate(const SunRiseFix *track, int fixes, time_t t);
+    void calculate(double latitude, double longitude, time_t t,
+		   const SunRiseHorizonMask &mask);
+    void calculate(double latitude, double longitude, time_t t,
+		   const SunRiseConditions &conditions);
+    void calculateDay(double latitude, double longitude, time_t start);
+    void pack(SunRisePacked *p) const;
+    void unpack(const SunRisePacked *p);
 
   private:
-    void testSunRiseSet(int i, double offsetDays, double latitude, double longitude,
-			struct skyCoordinates *mp);
-    struct skyCoordinates sun(double dayOffset);
-    double interpolate(double f0, double f1, double f2, double p);
-    double julianDate(time_t t);
-    double localSiderealTime(double offsetDays, double longitude);
     void initClass();
 };
 #endif
@@ -0,0 +1,60 @@
+// Sun rise/set calculation using a table of the sun's position through the
+// year.
+//
+// Copyright 2020 Cyrus Rahman
+// You may use or modify this source code in any way you find useful, provided
+// that you agree that the author(s) have no warranty, obligations or liability.  You
+// must determine the suitability of this source code for your use.
+//
+// Redistributions of this source code must retain this copyright notice.
+
+#include <math.h>
+#include <stdint.h>
+#include "SunRiseAnnual.h"
+#include "SunRiseKernel.h"
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#endif
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_word
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#endif
+
+#include "SunRiseAnnualTable.h"
+
+// The sun's position at the phase of the tropical year of a time in days
+// since Jan 1, 2000, 1200UTC.
+SunRiseCoordinates
+SunRiseAnnualEphemeris::position(double dayOffset) {
+  double x = dayOffset / SR_TROPICAL_YEAR;
+  x = (x - floor(x)) * SR_ANNUAL_ENTRIES;
+  int i = (int)x;
+  if (i >= SR_ANNUAL_ENTRIES)
+    i = SR_ANNUAL_ENTRIES - 1;
+  int j = i + 1 < SR_ANNUAL_ENTRIES ? i + 1 : 0;
+  double f = x - i;
+
+  double d0 = (int16_t)pgm_read_word(&sunAnnualTable[i][0]);
+  double d1 = (int16_t)pgm_read_word(&sunAnnualTable[j][0]);
+  double r0 = (int16_t)pgm_read_word(&sunAnnualTable[i][1]);
+  double r1 = (int16_t)pgm_read_word(&sunAnnualTable[j][1]);
+
+  SunRiseCoordinates sc;
+  sc.declination = (d0 + f * (d1 - d0)) * (M_PI / 180000);
+
+  double l = (SR_MEAN_LONGITUDE(dayOffset) + (r0 + f * (r1 - r0)) / 1000) / 360;
+  sc.RA = (l - floor(l)) * 2 * M_PI;
+  return(sc);
+}
+
+// Determine the nearest sun rise or set event previous, and the nearest
+// sun rise or set event subsequent, to the specified time, as
+// SunRise::calculate() does.
+void
+SunRiseAnnual::calculate(double latitude, double longitude, time_t t) {
+  SunRiseKernel<SunRiseLibMath, SunRiseAnnualEphemeris>::calculate(this, latitude,
+								    longitude, t);
+}
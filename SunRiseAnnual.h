@@ -0,0 +1,36 @@
+#ifndef SunRiseAnnual_h
+#define SunRiseAnnual_h
+
+// Sun rise/set with the sun's position taken from a table of one year.
+//
+// The sun's declination, and its right ascension less that of the mean sun,
+// repeat with the tropical year closely enough for applications that can
+// accept an error of a minute or two.  SunRiseAnnual replaces the three
+// evaluations of the sun's position in each calculation with interpolation in
+// a table of SR_ANNUAL_ENTRIES pairs of these (about 1.5 KB of flash, in
+// PROGMEM), and otherwise searches exactly as SunRise::calculate() does.
+//
+//	SunRiseAnnual sr;
+//	sr.calculate(latitude, longitude, t);
+
+#include "SunRise.h"
+#include "SunRiseKernel.h"
+
+#define SR_ANNUAL_ENTRIES   366
+#define SR_TROPICAL_YEAR    365.24219	    // Days
+
+// Longitude of the mean sun in degrees, at a time in days since Jan 1, 2000,
+// 1200UTC.
+#define SR_MEAN_LONGITUDE(d)	(280.46646 + 0.98564736 * (d))
+
+// The sun's position by linear interpolation in the table, as an ephemeris for
+// SunRiseKernel.
+struct SunRiseAnnualEphemeris {
+  static SunRiseCoordinates position(double dayOffset);
+};
+
+class SunRiseAnnual : public SunRise {
+  public:
+    void calculate(double latitude, double longitude, time_t t);
+};
+#endif
@@ -0,0 +1,99 @@
+// Sun position through one tropical year for SunRiseAnnual.
+// Generated by extras/sunriseAnnualTable; do not edit.
+//
+// { declination, right ascension - mean longitude } in 0.001 degree.
+
+static const int16_t sunAnnualTable[SR_ANNUAL_ENTRIES][2] PROGMEM = {
+  { -23024,   805 }, { -22941,   922 }, { -22850,  1038 }, { -22752,  1153 },
+  { -22647,  1266 }, { -22534,  1377 }, { -22414,  1487 }, { -22286,  1594 },
+  { -22151,  1699 }, { -22009,  1802 }, { -21860,  1903 }, { -21703,  2001 },
+  { -21540,  2097 }, { -21370,  2191 }, { -21193,  2281 }, { -21009,  2369 },
+  { -20819,  2454 }, { -20622,  2537 }, { -20418,  2616 }, { -20209,  2692 },
+  { -19992,  2765 }, { -19770,  2835 }, { -19541,  2902 }, { -19307,  2966 },
+  { -19067,  3026 }, { -18820,  3083 }, { -18569,  3137 }, { -18311,  3188 },
+  { -18048,  3235 }, { -17780,  3279 }, { -17506,  3319 }, { -17227,  3356 },
+  { -16943,  3389 }, { -16655,  3420 }, { -16361,  3447 }, { -16063,  3470 },
+  { -15760,  3490 }, { -15452,  3507 }, { -15141,  3520 }, { -14825,  3531 },
+  { -14504,  3537 }, { -14180,  3541 }, { -13852,  3542 }, { -13520,  3539 },
+  { -13184,  3533 }, { -12845,  3524 }, { -12503,  3513 }, { -12157,  3498 },
+  { -11807,  3480 }, { -11455,  3459 }, { -11100,  3436 }, { -10741,  3410 },
+  { -10380,  3381 }, { -10017,  3349 }, {  -9650,  3315 }, {  -9282,  3278 },
+  {  -8911,  3239 }, {  -8538,  3198 }, {  -8162,  3154 }, {  -7785,  3108 },
+  {  -7406,  3060 }, {  -7025,  3010 }, {  -6642,  2958 }, {  -6258,  2904 },
+  {  -5873,  2848 }, {  -5486,  2791 }, {  -5098,  2731 }, {  -4708,  2671 },
+  {  -4318,  2608 }, {  -3927,  2544 }, {  -3535,  2479 }, {  -3142,  2413 },
+  {  -2749,  2345 }, {  -2355,  2276 }, {  -1961,  2207 }, {  -1566,  2136 },
+  {  -1171,  2064 }, {   -777,  1992 }, {   -382,  1919 }, {     13,  1846 },
+  {    407,  1772 }, {    801,  1697 }, {   1195,  1622 }, {   1588,  1547 },
+  {   1981,  1472 }, {   2372,  1397 }, {   2763,  1321 }, {   3153,  1246 },
+  {   3542,  1171 }, {   3930,  1096 }, {   4317,  1022 }, {   4703,   948 },
+  {   5087,   874 }, {   5469,   801 }, {   5850,   729 }, {   6229,   657 },
+  {   6607,   586 }, {   6982,   516 }, {   7356,   447 }, {   7727,   379 },
+  {   8097,   312 }, {   8464,   246 }, {   8829,   181 }, {   9191,   118 },
+  {   9551,    56 }, {   9908,    -4 }, {  10262,   -63 }, {  10614,  -121 },
+  {  10962,  -177 }, {  11308,  -231 }, {  11650,  -283 }, {  11990,  -334 },
+  {  12326,  -383 }, {  12658,  -430 }, {  12988,  -475 }, {  13313,  -518 },
+  {  13635,  -559 }, {  13954,  -598 }, {  14268,  -635 }, {  14579,  -670 },
+  {  14885,  -702 }, {  15187,  -733 }, {  15486,  -761 }, {  15780,  -787 },
+  {  16069,  -810 }, {  16355,  -831 }, {  16635,  -850 }, {  16911,  -867 },
+  {  17183,  -881 }, {  17449,  -893 }, {  17711,  -902 }, {  17968,  -910 },
+  {  18220,  -914 }, {  18466,  -917 }, {  18708,  -917 }, {  18944,  -914 },
+  {  19175,  -910 }, {  19401,  -903 }, {  19621,  -893 }, {  19835,  -882 },
+  {  20044,  -868 }, {  20247,  -852 }, {  20445,  -833 }, {  20636,  -813 },
+  {  20822,  -790 }, {  21002,  -766 }, {  21176,  -739 }, {  21343,  -710 },
+  {  21505,  -680 }, {  21660,  -647 }, {  21810,  -613 }, {  21952,  -577 },
+  {  22089,  -539 }, {  22219,  -500 }, {  22343,  -459 }, {  22460,  -417 },
+  {  22571,  -373 }, {  22675,  -328 }, {  22772,  -281 }, {  22863,  -234 },
+  {  22948,  -185 }, {  23025,  -136 }, {  23096,   -85 }, {  23160,   -34 },
+  {  23217,    18 }, {  23268,    71 }, {  23312,   124 }, {  23348,   177 },
+  {  23379,   231 }, {  23402,   286 }, {  23418,   340 }, {  23428,   394 },
+  {  23430,   449 }, {  23426,   503 }, {  23415,   557 }, {  23397,   610 },
+  {  23373,   663 }, {  23341,   716 }, {  23303,   768 }, {  23258,   819 },
+  {  23206,   870 }, {  23147,   919 }, {  23082,   968 }, {  23010,  1015 },
+  {  22932,  1061 }, {  22846,  1106 }, {  22754,  1150 }, {  22656,  1192 },
+  {  22551,  1233 }, {  22440,  1272 }, {  22322,  1310 }, {  22198,  1345 },
+  {  22067,  1379 }, {  21931,  1411 }, {  21788,  1441 }, {  21638,  1469 },
+  {  21483,  1496 }, {  21322,  1520 }, {  21154,  1541 }, {  20981,  1561 },
+  {  20802,  1578 }, {  20617,  1593 }, {  20426,  1606 }, {  20230,  1617 },
+  {  20028,  1625 }, {  19820,  1630 }, {  19607,  1633 }, {  19389,  1634 },
+  {  19165,  1632 }, {  18936,  1628 }, {  18702,  1621 }, {  18463,  1612 },
+  {  18219,  1600 }, {  17969,  1586 }, {  17715,  1569 }, {  17456,  1550 },
+  {  17193,  1528 }, {  16925,  1503 }, {  16652,  1476 }, {  16375,  1447 },
+  {  16093,  1415 }, {  15807,  1381 }, {  15517,  1344 }, {  15223,  1305 },
+  {  14925,  1264 }, {  14623,  1220 }, {  14317,  1174 }, {  14007,  1126 },
+  {  13693,  1076 }, {  13376,  1023 }, {  13056,   969 }, {  12731,   912 },
+  {  12404,   853 }, {  12073,   792 }, {  11739,   730 }, {  11403,   665 },
+  {  11063,   599 }, {  10720,   531 }, {  10374,   461 }, {  10026,   390 },
+  {   9674,   317 }, {   9321,   242 }, {   8965,   166 }, {   8606,    89 },
+  {   8245,    11 }, {   7882,   -69 }, {   7517,  -150 }, {   7150,  -232 },
+  {   6781,  -315 }, {   6410,  -399 }, {   6037,  -484 }, {   5663,  -570 },
+  {   5287,  -656 }, {   4910,  -743 }, {   4531,  -831 }, {   4151,  -919 },
+  {   3769, -1007 }, {   3387, -1096 }, {   3003, -1185 }, {   2619, -1274 },
+  {   2234, -1364 }, {   1848, -1453 }, {   1461, -1542 }, {   1074, -1631 },
+  {    686, -1719 }, {    298, -1808 }, {    -91, -1896 }, {   -479, -1983 },
+  {   -868, -2070 }, {  -1257, -2156 }, {  -1646, -2241 }, {  -2034, -2326 },
+  {  -2422, -2409 }, {  -2810, -2492 }, {  -3197, -2573 }, {  -3584, -2653 },
+  {  -3970, -2732 }, {  -4356, -2809 }, {  -4740, -2885 }, {  -5124, -2960 },
+  {  -5506, -3033 }, {  -5887, -3104 }, {  -6267, -3174 }, {  -6646, -3241 },
+  {  -7023, -3307 }, {  -7399, -3370 }, {  -7773, -3432 }, {  -8145, -3491 },
+  {  -8515, -3548 }, {  -8883, -3603 }, {  -9249, -3656 }, {  -9613, -3706 },
+  {  -9975, -3753 }, { -10334, -3798 }, { -10690, -3840 }, { -11044, -3879 },
+  { -11396, -3916 }, { -11744, -3950 }, { -12089, -3980 }, { -12432, -4008 },
+  { -12771, -4033 }, { -13107, -4055 }, { -13439, -4073 }, { -13768, -4089 },
+  { -14094, -4101 }, { -14415, -4110 }, { -14733, -4115 }, { -15047, -4118 },
+  { -15356, -4117 }, { -15662, -4112 }, { -15963, -4104 }, { -16260, -4093 },
+  { -16552, -4078 }, { -16840, -4059 }, { -17122, -4037 }, { -17400, -4012 },
+  { -17673, -3983 }, { -17941, -3950 }, { -18204, -3914 }, { -18462, -3875 },
+  { -18714, -3832 }, { -18960, -3785 }, { -19201, -3735 }, { -19436, -3682 },
+  { -19666, -3625 }, { -19889, -3564 }, { -20107, -3501 }, { -20318, -3434 },
+  { -20523, -3364 }, { -20722, -3291 }, { -20915, -3214 }, { -21101, -3135 },
+  { -21280, -3052 }, { -21453, -2967 }, { -21619, -2878 }, { -21778, -2787 },
+  { -21930, -2693 }, { -22075, -2597 }, { -22214, -2498 }, { -22345, -2397 },
+  { -22468, -2293 }, { -22585, -2187 }, { -22694, -2079 }, { -22796, -1970 },
+  { -22891, -1858 }, { -22977, -1744 }, { -23057, -1629 }, { -23129, -1513 },
+  { -23193, -1395 }, { -23249, -1276 }, { -23298, -1155 }, { -23339, -1034 },
+  { -23373,  -912 }, { -23399,  -789 }, { -23416,  -666 }, { -23426,  -542 },
+  { -23429,  -419 }, { -23423,  -294 }, { -23410,  -170 }, { -23389,   -47 },
+  { -23360,    77 }, { -23323,   200 }, { -23279,   323 }, { -23226,   444 },
+  { -23167,   565 }, { -23099,   685 },
+};
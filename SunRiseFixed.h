@@ -0,0 +1,51 @@
+#ifndef SunRiseFixed_h
+#define SunRiseFixed_h
+
+// Sun rise/set calculation specialized for a site known at compile time.
+//
+// The location is a class providing its latitude and longitude in degrees:
+//
+//	struct Home {
+//	  static constexpr double latitude = 42;
+//	  static constexpr double longitude = -90;
+//	};
+//
+//	SunRiseFixed<Home> sr;
+//	sr.calculate(t);
+//
+// The sine and cosine of the latitude and the horizon constant are computed
+// by the compiler (with C++14, otherwise once at startup), leaving only the
+// solar position and the hourly test to be done at run time.  The results are
+// those of SunRise::calculate() to within rounding: with C++14 the constants
+// come from SunRiseConstMath rather than the math library, and may differ from
+// it in the last bits.  extras/sunriseCheck tests that events agree to a
+// second.
+
+#include "SunRise.h"
+#include "SunRiseKernel.h"
+
+template <class Location>
+class SunRiseFixed : public SunRise {
+  public:
+    void calculate(time_t t) {
+      SunRiseKernel<SunRiseLibMath>::search(this, site, t);
+    }
+
+  private:
+#if __cplusplus >= 201402L
+    static constexpr SunRiseSite site =
+      SunRiseKernel<SunRiseConstMath>::site(Location::latitude, Location::longitude);
+#else
+    static const SunRiseSite site;
+#endif
+};
+
+#if __cplusplus >= 201402L
+template <class Location>
+constexpr SunRiseSite SunRiseFixed<Location>::site;
+#else
+template <class Location>
+const SunRiseSite SunRiseFixed<Location>::site =
+  SunRiseKernel<SunRiseLibMath>::site(Location::latitude, Location::longitude);
+#endif
+#endif
@@ -0,0 +1,1039 @@
+#ifndef SunRiseKernel_h
+#define SunRiseKernel_h
+
+// The sun rise/set search, templated on the math functions it uses, on the
+// source of the sun's position, and on the altitude of the sun at rise and
+// set.  Given the position and horizon of another body, such as the moon (see
+// SunRiseMoon.h), it finds that body's rise and set instead.
+//
+// SunRise::calculate() instantiates the kernel with the C library math
+// functions and the Van Flandern & Pulkkinen series (see SunRiseAnnual.cpp
+// and SunRisePrecise.cpp for other ephemerides).  With a C++14 compiler the
+// kernel is also constexpr, and instantiated with SunRiseConstMath it can be
+// evaluated by the compiler:
+//
+//	constexpr SunRise sr = sunRiseAt(42, -90, 1700000000);
+//	static_assert(sr.hasRise && sr.hasSet, "");
+//
+// Under C++11 (as on the ATmega Arduinos) SR_CONSTEXPR is empty and the
+// kernel is an ordinary template.
+
+#include <math.h>
+#include "SunRise.h"
+
+#if __cplusplus >= 201402L
+#define SR_CONSTEXPR constexpr
+#else
+#define SR_CONSTEXPR
+#endif
+
+// Radians of sidereal rotation per hour of solar time.
+#define SR_K1 15*(M_PI/180)*1.0027379
+
+// A body's geocentric position, in radians.
+struct SunRiseCoordinates {
+  double RA;		    // Right ascension
+  double declination;	    // Declination
+};
+
+// Observer constants used by the hourly test, computed once per search, or
+// once at compile time for a fixed site (see SunRiseFixed.h).
+struct SunRiseSite {
+  double sinLatitude;
+  double cosLatitude;
+  double longitude;	    // Degrees
+  double horizon;	    // Cosine of the zenith distance of the event
+};
+
+// The C library math functions, for run time use.
+struct SunRiseLibMath {
+  static double sin(double x) { return(::sin(x)); }
+  static double cos(double x) { return(::cos(x)); }
+  static double atan(double x) { return(::atan(x)); }
+  static double atan2(double y, double x) { return(::atan2(y, x)); }
+  static double sqrt(double x) { return(::sqrt(x)); }
+  static double floor(double x) { return(::floor(x)); }
+  static double remainder(double x, double y) {
+#if __ISO_C_VISIBLE < 1999
+    // Arduino compiler is missing this function as of 6/2020.
+    //
+    // The Arduino ATmega platforms (including the Uno) are also missing rint().
+    // This can be worked around by using "(double)lrint(x / y)" here, but since
+    // these platforms use only four bytes for double precision - which is
+    // insufficient for the correct performance of the required calculations -
+    // you should instead upgrade to an Arduino Due or better.
+    return((double)x - (double)y * rint((double)x / (double)y));
+#else
+    return(::remainder(x, y));
+#endif
+  }
+};
+
+#if __cplusplus >= 201402L
+// Math functions usable in constant expressions.  They agree with the C
+// library to about 1e-15 over the ranges used here, but are far slower.
+struct SunRiseConstMath {
+  static constexpr double floor(double x) {
+    double f = (double)(long long)x;
+    return(f > x ? f - 1 : f);
+  }
+  static constexpr double remainder(double x, double y) {
+    double q = x / y;
+    double n = floor(q + 0.5);
+    if (n - q == 0.5 && (long long)n % 2 != 0)
+      n -= 1;			    // Round half to even, as rint() does.
+    return(x - y * n);
+  }
+  static constexpr double sin(double x) {
+    x = remainder(x, 2 * M_PI);	    // -pi .. pi
+    if (x > M_PI / 2)
+      x = M_PI - x;
+    else if (x < -M_PI / 2)
+      x = -M_PI - x;
+    double term = x, sum = x;
+    for (int n = 1; n < 14; n++) {
+      term *= -x * x / ((2 * n) * (2 * n + 1));
+      sum += term;
+    }
+    return(sum);
+  }
+  static constexpr double cos(double x) {
+    return(sin(x + M_PI / 2));
+  }
+  static constexpr double sqrt(double x) {
+    if (x <= 0)
+      return(0);
+    double r = x > 1 ? x : 1;
+    for (int i = 0; i < 100; i++) {
+      double next = (r + x / r) / 2;
+      if (next >= r)
+	break;
+      r = next;
+    }
+    return(r);
+  }
+  static constexpr double atan(double x) {
+    if (x < 0)
+      return(-atan(-x));
+    if (x > 1)
+      return(M_PI / 2 - atan(1 / x));
+    // Halve the angle twice to speed convergence of the series.
+    x = x / (1 + sqrt(1 + x * x));
+    x = x / (1 + sqrt(1 + x * x));
+    double term = x, sum = x;
+    for (int n = 1; n < 30; n++) {
+      term *= -x * x;
+      sum += term / (2 * n + 1);
+    }
+    return(4 * sum);
+  }
+  static constexpr double atan2(double y, double x) {
+    if (x > 0)
+      return(atan(y / x));
+    if (x < 0)
+      return(y < 0 ? atan(y / x) - M_PI : atan(y / x) + M_PI);
+    return(y > 0 ? M_PI / 2 : (y < 0 ? -M_PI / 2 : 0));
+  }
+};
+#endif
+
+// The body's position.  The ephemeris is a class with a static member
+//
+//	SunRiseCoordinates position(double dayOffset);
+//
+// giving the geocentric right ascension and declination in radians at a time
+// in days since Jan 1, 2000, 1200UTC.  SunRiseSeries, for the sun, is the one
+// used by SunRise::calculate().
+template <class Math>
+struct SunRiseSeries {
+  static SR_CONSTEXPR SunRiseCoordinates position(double dayOffset);
+};
+
+// The body's altitude at rise and set.  The horizon model is a class with a
+// static member
+//
+//	double zenith();
+//
+// giving the zenith distance in degrees of the body's centre at the moment of
+// rising or setting: 90 degrees, plus refraction at the horizon and the
+// body's semidiameter, less its parallax.
+struct SunRiseSunHorizon {
+  static SR_CONSTEXPR double zenith() { return(90.833); }
+};
+
+// A point of light such as a star or planet, with refraction only.
+struct SunRisePointHorizon {
+  static SR_CONSTEXPR double zenith() { return(90.5667); }
+};
+
+// The beginning and end of civil, nautical and astronomical twilight, when the
+// sun's centre is 6, 12 and 18 degrees below the horizon.
+struct SunRiseCivilTwilight {
+  static SR_CONSTEXPR double zenith() { return(96); }
+};
+
+struct SunRiseNauticalTwilight {
+  static SR_CONSTEXPR double zenith() { return(102); }
+};
+
+struct SunRiseAstronomicalTwilight {
+  static SR_CONSTEXPR double zenith() { return(108); }
+};
+
+// The search window and the step between altitude tests, in hours and in
+// minutes, and the number of evenly spaced points at which the sun's position
+// is evaluated and interpolated across the window.  Three points follow the
+// sun well over two days; five or seven cover a week or more.
+template <int Window = SR_WINDOW, int Step = SR_STEP, int Points = SR_POINTS>
+struct SunRiseGrid {
+  enum { window = Window, step = Step, steps = Window * 60 / Step, points = Points };
+};
+
+template <class Math, class Ephemeris = SunRiseSeries<Math>,
+	  class Grid = SunRiseGrid<>, class Horizon = SunRiseSunHorizon>
+class SunRiseKernel {
+  static_assert(Grid::step % 2 == 0 && Grid::window * 60 % Grid::step == 0,
+		"the step must be an even number of minutes dividing the window");
+  static_assert(Grid::points >= 2, "at least two points are interpolated");
+
+  public:
+    // The sun's position at the grid's points spread evenly through a span of
+    // time, prepared for interpolation.  One sky found by sky() serves every
+    // search whose window lies within it.
+    struct Sky {
+      double ra[Grid::points];
+      double declination[Grid::points];
+      double start;	    // Days since Jan 1, 2000, 1200UTC, of the first point.
+      double days;	    // From the first point to the last.
+    };
+
+    static SR_CONSTEXPR void calculate(SunRise *sr, double latitude, double longitude,
+				       time_t t);
+    static SR_CONSTEXPR void search(SunRise *sr, const SunRiseSite &site, time_t t);
+    static SR_CONSTEXPR void search(SunRise *sr, const SunRiseSite &site, time_t t,
+				    const Sky &sky);
+    static SR_CONSTEXPR void sky(Sky *s, time_t from, time_t to);
+    static SR_CONSTEXPR void searchTrack(SunRise *sr, const SunRiseFix *track,
+					 int fixes, time_t t);
+    static SR_CONSTEXPR void searchMask(SunRise *sr, const SunRiseSite &site,
+					const SunRiseHorizonMask &mask, time_t t);
+    static SR_CONSTEXPR void searchFrom(SunRise *sr, double latitude, double longitude,
+					time_t start);
+    static SR_CONSTEXPR int events(double latitude, double longitude, time_t start,
+				   SunRiseEvent *list, int max);
+    static SR_CONSTEXPR SunRiseSite site(double latitude, double longitude);
+    static SR_CONSTEXPR SunRiseSite site(double latitude, double longitude,
+					 const SunRiseConditions &conditions);
+    static SR_CONSTEXPR double horizon(const SunRiseConditions &conditions);
+    static SR_CONSTEXPR SunRiseCoordinates position(double dayOffset);
+    static SR_CONSTEXPR double interpolate(double f0, double f1, double f2, double p);
+    static SR_CONSTEXPR void prepare(double *f, int n);
+    static SR_CONSTEXPR double interpolate(const double *f, int n, double p);
+    static SR_CONSTEXPR double julianDate(time_t t);
+    static SR_CONSTEXPR double localSiderealTime(double offsetDays, double longitude);
+
+  private:
+    // An observer who stays at one site.
+    struct FixedObserver {
+      SunRiseSite site;
+      SR_CONSTEXPR double longitude() const { return(site.longitude); }
+      SR_CONSTEXPR SunRiseSite at(int) const { return(site); }
+    };
+
+    // An observer moving along a track of time-stamped positions.  Since the
+    // scan asks for positions in time order, the fix reached so far is kept,
+    // with its longitude unwrapped across the date line so that the offsets
+    // from the first fix's longitude are continuous.
+    struct TrackObserver {
+      const SunRiseFix *track;
+      int fixes;
+      time_t start;	    // Beginning of the search window.
+      mutable int fix;
+      mutable double unwrapped;
+      SR_CONSTEXPR double longitude() const { return(track[0].longitude); }
+      SR_CONSTEXPR SunRiseSite at(int minutes) const;
+      static SR_CONSTEXPR double shortWay(double dLongitude);
+    };
+
+    // An observer at one site with terrain on the horizon.  The sun's altitude
+    // test is always below low under the lowest terrain, and above high over
+    // the highest.  Band is where the sun was at the end of the last step
+    // tested: -1 below the terrain's range of altitude, 0 within it, 1 above.
+    struct MaskedObserver {
+      SunRiseSite site;
+      SunRiseHorizonMask mask;
+      double low, high;
+      mutable int band;
+      SR_CONSTEXPR double longitude() const { return(site.longitude); }
+      SR_CONSTEXPR SunRiseSite at(int) const { return(site); }
+    };
+
+    // Keeps the nearest events before and after the query time.
+    struct NearestEvents {
+      SunRise *sr;
+      SR_CONSTEXPR void start(time_t t) const;
+      SR_CONSTEXPR void event(bool rise, time_t eventTime, double az) const;
+      SR_CONSTEXPR void finish(double altitude) const;
+    };
+
+    // Keeps the first rise and the first set in the window.
+    struct FirstEvents {
+      SunRise *sr;
+      SR_CONSTEXPR void start(time_t t) const {
+	NearestEvents nearest = { sr };
+	nearest.start(t);
+      }
+      SR_CONSTEXPR void event(bool rise, time_t eventTime, double az) const;
+      SR_CONSTEXPR void finish(double altitude) const;
+    };
+
+    // Keeps every event in the window, in time order.
+    struct AllEvents {
+      SunRiseEvent *list;
+      int max;
+      int *count;
+      SR_CONSTEXPR void start(time_t) const { *count = 0; }
+      SR_CONSTEXPR void event(bool rise, time_t eventTime, double az) const {
+	if (*count < max) {
+	  list[*count].time = eventTime;
+	  list[*count].azimuth = az;
+	  list[*count].rise = rise;
+	}
+	(*count)++;
+      }
+      SR_CONSTEXPR void finish(double) const {}
+    };
+
+    template <class Observer, class Recorder>
+    static SR_CONSTEXPR void scan(const Recorder &recorder, const Observer &observer,
+				  time_t t, int leadHours);
+    template <class Observer, class Recorder>
+    static SR_CONSTEXPR void scan(const Recorder &recorder, const Observer &observer,
+				  time_t t, int leadHours, double offsetDays,
+				  const Sky &sky, double first, double scale);
+    static SR_CONSTEXPR void fill(Sky *s, double start, double hours);
+    template <class Recorder, class Observer>
+    static SR_CONSTEXPR double testSunRiseSet(const Recorder &recorder, const Observer &observer,
+					      time_t t, int leadHours, int k, double lSideTime,
+					      double previous,
+					      const SunRiseSite &start,
+					      const SunRiseSite &middle, const SunRiseSite &end,
+					      SunRiseCoordinates *sp);
+    template <class Recorder>
+    static SR_CONSTEXPR double testSunRiseSet(const Recorder &recorder,
+					      const MaskedObserver &observer,
+					      time_t t, int leadHours, int k, double lSideTime,
+					      double previous,
+					      const SunRiseSite &start,
+					      const SunRiseSite &middle, const SunRiseSite &end,
+					      SunRiseCoordinates *sp);
+    static SR_CONSTEXPR double maskAltitude(const MaskedObserver &observer,
+					    const SunRiseSite &site, double declination,
+					    double ha, int *band);
+    static SR_CONSTEXPR double maskThreshold(double altitude);
+};
+
+// Determine the nearest sun rise or set event previous, and the nearest
+// sun rise or set event subsequent, to the specified time in seconds since the
+// Unix epoch (January 1, 1970) and at the specified latitude and longitude in
+// degrees.
+//
+// We look for events from SR_WINDOW/2 hours in the past to SR_WINDOW/2 hours
+// in the future.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::calculate(SunRise *sr, double latitude, double longitude, time_t t) {
+  search(sr, site(latitude, longitude), t);
+}
+
+// Compute the observer constants for a latitude and longitude in degrees.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR SunRiseSite
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::site(double latitude, double longitude) {
+  SunRiseSite site = {};
+  site.sinLatitude = Math::sin(M_PI / 180 * latitude);
+  site.cosLatitude = Math::cos(M_PI / 180 * latitude);
+  site.longitude = longitude;
+
+  // refraction + semidiameter - parallax at horizon
+  site.horizon = Math::cos(M_PI / 180 * Horizon::zenith());
+  return(site);
+}
+
+// Compute the observer constants for an observer in the given conditions.
+// The horizon constant is all that changes, so the search costs the same.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR SunRiseSite
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::site(double latitude, double longitude,
+						    const SunRiseConditions &conditions) {
+  SunRiseSite s = site(latitude, longitude);
+  s.horizon = horizon(conditions);
+  return(s);
+}
+
+// The cosine of the zenith distance of the event for an observer in the given
+// conditions.  Refraction at the horizon, 0.5667 degrees in the standard
+// conditions, is in proportion to the density of the air (Meeus, Astronomical
+// Algorithms, ch. 16).  The horizon dips 1.76 arc minutes times the square
+// root of the observer's height in metres, allowing for terrestrial
+// refraction.  With no pressure given, the standard refraction is used.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR double
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::horizon(const SunRiseConditions &conditions) {
+  double refraction = conditions.pressure > 0 ?
+    0.5667 * conditions.pressure / 1010 * 283 / (273 + conditions.temperature) : 0.5667;
+  double dip = conditions.height > 0 ? 1.76 / 60 * Math::sqrt(conditions.height) : 0;
+  return(Math::cos(M_PI / 180 * (Horizon::zenith() - 0.5667 + refraction + dip)));
+}
+
+// Search for events at a site whose constants have been computed.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::search(SunRise *sr, const SunRiseSite &site, time_t t) {
+  FixedObserver observer = { site };
+  NearestEvents recorder = { sr };
+  scan(recorder, observer, t, Grid::window / 2);
+}
+
+// Search for events at a site using the sun's positions from a shared sky,
+// saving their evaluation.  The positions through the window are
+// interpolated from the sky's points rather than from points of the window's
+// own, so event times may differ from search()'s by a second or so.  If the
+// window is not within the sky, the positions are found as usual.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::search(SunRise *sr, const SunRiseSite &site,
+						      time_t t, const Sky &sky) {
+  FixedObserver observer = { site };
+  NearestEvents recorder = { sr };
+  double offsetDays = julianDate(t) - 2451545L;
+  offsetDays -= (double)(Grid::window / 2) / 24;
+
+  double first = (offsetDays - sky.start) / sky.days;
+  double scale = (double)Grid::window / 24 / sky.days;
+  if (!(first >= -1e-9 && first + scale <= 1 + 1e-9)) {
+    scan(recorder, observer, t, Grid::window / 2);
+    return;
+  }
+  scan(recorder, observer, t, Grid::window / 2, offsetDays, sky, first, scale);
+}
+
+// Find the sun's positions for the searches of every time from one time to
+// another: over their windows, from half a window before the first to half a
+// window after the last.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::sky(Sky *s, time_t from, time_t to) {
+  double offsetDays = julianDate(from) - 2451545L;
+  offsetDays -= (double)(Grid::window / 2) / 24;
+  fill(s, offsetDays, Grid::window + (double)(to - from) / 3600);
+}
+
+// Evaluate the sun's position at the grid's points through the given number
+// of hours from start, in days since Jan 1, 2000, 1200UTC.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::fill(Sky *s, double start, double hours) {
+  for (int i = 0; i < Grid::points; i ++) {
+    SunRiseCoordinates sc = position(start + i * hours / ((Grid::points - 1) * 24));
+    s->ra[i] = sc.RA;
+    s->declination[i] = sc.declination;
+  }
+
+  // If the RA wraps around during this period, unwrap it to keep the
+  // sequence smooth for interpolation.
+  for (int i = 1; i < Grid::points; i++)
+    if (s->ra[i] <= s->ra[i - 1])
+      s->ra[i] += 2 * M_PI;
+  prepare(s->ra, Grid::points);
+  prepare(s->declination, Grid::points);
+  s->start = start;
+  s->days = hours / 24;
+}
+
+// Find the first sun rise and the first sun set in the window beginning at
+// the specified time, rather than the nearest events on either side of it.
+// isVisible is set for the start of the window.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::searchFrom(SunRise *sr, double latitude,
+							  double longitude, time_t start) {
+  FixedObserver observer = { site(latitude, longitude) };
+  FirstEvents recorder = { sr };
+  scan(recorder, observer, start, 0);
+}
+
+// List every event from the specified time to the end of the window, storing
+// at most max of them.  Returns the number found.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR int
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::events(double latitude, double longitude,
+						      time_t start, SunRiseEvent *list, int max) {
+  int count = 0;
+  FixedObserver observer = { site(latitude, longitude) };
+  AllEvents recorder = { list, max, &count };
+  scan(recorder, observer, start, 0);
+  return(count);
+}
+
+// Search for events seen by an observer moving along a track.  The fixes must
+// be in time order; the observer is taken to move in a straight line (in
+// latitude and longitude) between fixes, and to stay at the first and last
+// fixes before and after the track.  The solar position is computed once for
+// the whole window as usual; only the observer's constants change each half
+// hour.  With no fixes, no events are found.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::searchTrack(SunRise *sr, const SunRiseFix *track, int fixes,
+				 time_t t) {
+  NearestEvents recorder = { sr };
+  if (fixes <= 0) {
+    recorder.start(t);
+    return;
+  }
+  TrackObserver observer = { track, fixes, t - Grid::window / 2 * 60 * 60L,
+			     0, track[0].longitude };
+  scan(recorder, observer, t, Grid::window / 2);
+}
+
+// Search for events at a site with terrain on the horizon, when the sun's
+// upper limb appears over or disappears behind it.  The sun's altitude is
+// compared with the terrain's only when it is within the range of the
+// terrain, so that away from the horizon each step costs no more than
+// usual.  An empty mask is a level horizon.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::searchMask(SunRise *sr, const SunRiseSite &site,
+							  const SunRiseHorizonMask &mask,
+							  time_t t) {
+  if (mask.count <= 0 || mask.altitude == NULL) {
+    search(sr, site, t);
+    return;
+  }
+  double lowest = mask.altitude[0], highest = mask.altitude[0];
+  for (int i = 1; i < mask.count; i++) {
+    if (mask.altitude[i] < lowest)
+      lowest = mask.altitude[i];
+    if (mask.altitude[i] > highest)
+      highest = mask.altitude[i];
+  }
+  MaskedObserver observer = { site, mask, maskThreshold(lowest), maskThreshold(highest), 0 };
+  NearestEvents recorder = { sr };
+  scan(recorder, observer, t, Grid::window / 2);
+}
+
+// The observer's constants at a number of minutes from the window start.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR SunRiseSite
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::TrackObserver::at(int minutes) const {
+  time_t when = start + minutes * 60L;
+
+  // Move between fixes the short way round across the date line.
+  while (fix < fixes - 1 && track[fix + 1].time <= when) {
+    unwrapped += shortWay(track[fix + 1].longitude - track[fix].longitude);
+    fix++;
+  }
+  if (fix == fixes - 1 || when <= track[fix].time)
+    return(site(track[fix].latitude, unwrapped));
+
+  double f = (double)(when - track[fix].time) / (track[fix + 1].time - track[fix].time);
+  return(site(track[fix].latitude + f * (track[fix + 1].latitude - track[fix].latitude),
+	      unwrapped + f * shortWay(track[fix + 1].longitude - track[fix].longitude)));
+}
+
+// A difference of longitude in degrees, taken the short way round.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR double
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::TrackObserver::shortWay(double dLongitude) {
+  if (dLongitude > 180)
+    return(dLongitude - 360);
+  if (dLongitude < -180)
+    return(dLongitude + 360);
+  return(dLongitude);
+}
+
+// The search proper, over the window beginning leadHours before t.  The
+// observer supplies its constants at the start, middle and end of each step
+// of the window, and the recorder receives the events found.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+template <class Observer, class Recorder>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::scan(const Recorder &recorder,
+						    const Observer &observer, time_t t,
+						    int leadHours) {
+  Sky own = {};
+  double offsetDays = 0;
+
+  offsetDays = julianDate(t) - 2451545L;     // Days since Jan 1, 2000, 1200UTC.
+  // Begin testing leadHours before requested time.
+  offsetDays -= (double)leadHours / 24;
+
+  // Calculate coordinates at evenly spaced points through the search period.
+  fill(&own, offsetDays, Grid::window);
+  scan(recorder, observer, t, leadHours, offsetDays, own, 0, 1);
+}
+
+// The search over the window beginning leadHours before t, offsetDays since
+// Jan 1, 2000, 1200UTC, with the sun's positions interpolated from a sky.
+// The window runs from first to first + scale of the way through the sky.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+template <class Observer, class Recorder>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::scan(const Recorder &recorder,
+						    const Observer &observer, time_t t,
+						    int leadHours, double offsetDays,
+						    const Sky &sky, double first, double scale) {
+  recorder.start(t);
+
+  // Get (local_sidereal_time - leadHours) in radians.
+  double lSideTime = localSiderealTime(offsetDays, observer.longitude()) * 2* M_PI / 360;
+
+  // Initialize interpolation array.
+  SunRiseCoordinates spWindow[3] = {};
+  spWindow[0].RA  = interpolate(sky.ra, Grid::points, first);
+  spWindow[0].declination = interpolate(sky.declination, Grid::points, first);
+  SunRiseSite siteStart = observer.at(0);
+  double altitude = 0;
+
+  for (int k = 0; k < Grid::steps; k++) {   // Check each interval of search period
+    float ph = (float)(k + 1)/(float)Grid::steps;
+
+    spWindow[2].RA = interpolate(sky.ra, Grid::points, first + scale * ph);
+    spWindow[2].declination = interpolate(sky.declination, Grid::points, first + scale * ph);
+
+    // Look for sunrise/set events during this interval.
+    SunRiseSite siteMiddle = observer.at(k * Grid::step + Grid::step / 2);
+    SunRiseSite siteEnd = observer.at((k + 1) * Grid::step);
+    altitude = testSunRiseSet(recorder, observer, t, leadHours, k, lSideTime, altitude,
+			      siteStart, siteMiddle, siteEnd, spWindow);
+
+    spWindow[0] = spWindow[2];		    // Advance to next interval.
+    siteStart = siteEnd;
+  }
+
+  recorder.finish(altitude);
+}
+
+// Look for sun rise or set events during step k, passing any found to the
+// recorder.  The local sidereal time is that at the window start for the
+// observer's initial longitude; the observer's longitude at the start, middle
+// and end of the step is applied as an offset from it.  Returns the sun's
+// altitude test value at the end of the step, which is negative if the sun is
+// below the horizon.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+template <class Recorder, class Observer>
+SR_CONSTEXPR double
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::testSunRiseSet(const Recorder &recorder,
+				    const Observer &observer, time_t t,
+				    int leadHours, int k, double lSideTime, double,
+				    const SunRiseSite &start,
+				    const SunRiseSite &middle, const SunRiseSite &end,
+				    SunRiseCoordinates *sp) {
+  double lSideLongitude = observer.longitude();
+  double ha[3] = {}, VHz[3] = {};
+  double hours = k * Grid::step / 60.0;	    // Start of the step
+  double span = (double)Grid::step / 60.0;  // Length of the step
+
+  // Calculate Hour Angle.
+  ha[0] = lSideTime - sp[0].RA + hours*SR_K1 + (start.longitude - lSideLongitude) * (M_PI / 180);
+  ha[2] = lSideTime - sp[2].RA + hours*SR_K1 + span*SR_K1 + (end.longitude - lSideLongitude) * (M_PI / 180);
+
+  // Hour Angle and declination at the middle of the step.
+  ha[1]  = (ha[2] + ha[0])/2;
+  sp[1].declination = (sp[2].declination + sp[0].declination)/2;
+
+  VHz[0] = start.sinLatitude * Math::sin(sp[0].declination) +
+	   start.cosLatitude * Math::cos(sp[0].declination) * Math::cos(ha[0]) - start.horizon;
+  VHz[2] = end.sinLatitude * Math::sin(sp[2].declination) +
+	   end.cosLatitude * Math::cos(sp[2].declination) * Math::cos(ha[2]) - end.horizon;
+
+  // Look for an event only if the sign changes this step.
+  if ((VHz[0] < 0) != (VHz[2] < 0)) {
+    double s = middle.sinLatitude;
+    double c = middle.cosLatitude;
+    double z = middle.horizon;
+
+    VHz[1] = s * Math::sin(sp[1].declination) + c * Math::cos(sp[1].declination) * Math::cos(ha[1]) - z;
+
+    double a = 2 * VHz[2] - 4 * VHz[1] + 2 * VHz[0];
+    double b = 4 * VHz[1] - 3 * VHz[0] - VHz[2];
+    double d = b * b - 4 * a * VHz[0];
+
+    if (d >= 0) {
+      d = Math::sqrt(d);
+      double e = (-b + d) / (2 * a);
+      if ((e < 0) || (e > 1))
+	e = (-b - d) / (2 * a);
+      double time = hours + e * span;	    // Time since k=0 of event (in hours).
+
+      // The time we started searching + the time from the start of the search to the
+      // event is the time of the event.  Add (time since k=0) - leadHours.
+      time_t eventTime = t + (time - leadHours) *60 *60;
+
+      double hz = ha[0] + e * (ha[2] - ha[0]);	    // Azimuth of the sun at the event.
+      double nz = -Math::cos(sp[1].declination) * Math::sin(hz);
+      double dz = c * Math::sin(sp[1].declination) - s * Math::cos(sp[1].declination) * Math::cos(hz);
+      double az = Math::atan2(nz, dz) / (M_PI / 180);
+      if (az < 0)
+	az += 360;
+
+      if ((VHz[0] < 0) && (VHz[2] > 0))
+	recorder.event(true, eventTime, az);
+      if ((VHz[0] > 0) && (VHz[2] < 0))
+	recorder.event(false, eventTime, az);
+    }
+  }
+  return(VHz[2]);
+}
+
+// Look for events during step k against the terrain on the horizon.  As on a
+// level horizon, an event is looked for only if the sign of the sun's
+// altitude test changes over the step; the test at the start is the previous
+// step's.  While the sun is within the terrain's range of altitude it may pass
+// behind several peaks in one step, so the step is then tested in parts of
+// SR_MASK_STEP minutes.  A part in which the sign changes is narrowed by false
+// position (the Illinois variant) to within a second.  Returns the test value
+// at the end of the step.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+template <class Recorder>
+SR_CONSTEXPR double
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::testSunRiseSet(const Recorder &recorder,
+				    const MaskedObserver &observer, time_t t,
+				    int leadHours, int k, double lSideTime,
+				    double previous, const SunRiseSite &,
+				    const SunRiseSite &site, const SunRiseSite &,
+				    SunRiseCoordinates *sp) {
+  double hours = k * Grid::step / 60.0;	    // Start of the step
+  double span = (double)Grid::step / 60.0;  // Length of the step
+  double ha0 = lSideTime - sp[0].RA + hours*SR_K1;
+  double ha2 = lSideTime - sp[2].RA + hours*SR_K1 + span*SR_K1;
+  double dec0 = sp[0].declination, dec2 = sp[2].declination;
+  int band0 = observer.band, band2 = 0, band = 0;
+  double v0 = k == 0 ? maskAltitude(observer, site, dec0, ha0, &band0) : previous;
+  double v2 = maskAltitude(observer, site, dec2, ha2, &band2);
+  observer.band = band2;
+
+  static_assert(Grid::step % SR_MASK_STEP == 0, "SR_MASK_STEP must divide the step");
+  int parts = band0 == 0 || band2 == 0 || band0 != band2 ? Grid::step / SR_MASK_STEP : 1;
+  double start = 0, vStart = v0;
+  for (int p = 1; p <= parts; p++) {
+    double end = (double)p / parts;
+    double vEnd = p == parts ? v2 : maskAltitude(observer, site, dec0 + end * (dec2 - dec0),
+						  ha0 + end * (ha2 - ha0), &band);
+    if ((vStart < 0) != (vEnd < 0)) {
+      double a = start, b = end;
+      double va = vStart, vb = vEnd;
+      int side = 0;
+      double e = a;
+      for (int i = 0; i < 20 && (b - a) * span * 60 * 60 > 1; i++) {
+	e = (a * vb - b * va) / (vb - va);
+	double ve = maskAltitude(observer, site, dec0 + e * (dec2 - dec0),
+				 ha0 + e * (ha2 - ha0), &band);
+	if ((ve < 0) == (va < 0)) {
+	  a = e;
+	  va = ve;
+	  if (side == -1)
+	    vb /= 2;
+	  side = -1;
+	} else {
+	  b = e;
+	  vb = ve;
+	  if (side == 1)
+	    va /= 2;
+	  side = 1;
+	}
+      }
+      e = (a + b) / 2;
+
+      double dec = dec0 + e * (dec2 - dec0), hz = ha0 + e * (ha2 - ha0);
+      double nz = -Math::cos(dec) * Math::sin(hz);
+      double dz = site.cosLatitude * Math::sin(dec) - site.sinLatitude * Math::cos(dec) * Math::cos(hz);
+      double az = Math::atan2(nz, dz) / (M_PI / 180);
+      if (az < 0)
+	az += 360;
+      time_t eventTime = t + (hours + e * span - leadHours) *60 *60;
+      recorder.event(vStart < 0, eventTime, az);
+    }
+    start = end;
+    vStart = vEnd;
+  }
+  return(v2);
+}
+
+// The sun's altitude test against the terrain: negative when the sun is
+// behind it.  Outside the range of the terrain the azimuth is not needed.
+// Band is set to where the sun is, as for MaskedObserver::band.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR double
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::maskAltitude(const MaskedObserver &observer,
+							    const SunRiseSite &site,
+							    double declination, double ha,
+							    int *band) {
+  double s = site.sinLatitude * Math::sin(declination) +
+	     site.cosLatitude * Math::cos(declination) * Math::cos(ha);
+  *band = s < observer.low ? -1 : (s > observer.high ? 1 : 0);
+  if (*band < 0)
+    return(s - observer.low);
+  if (*band > 0)
+    return(s - observer.high);
+
+  double nz = -Math::cos(declination) * Math::sin(ha);
+  double dz = site.cosLatitude * Math::sin(declination) -
+	      site.sinLatitude * Math::cos(declination) * Math::cos(ha);
+  double x = (Math::atan2(nz, dz) / (2 * M_PI) + 1) * observer.mask.count;
+  x -= observer.mask.count * Math::floor(x / observer.mask.count);
+  int i = (int)x;
+  if (i >= observer.mask.count)
+    i = 0;
+  int j = i + 1 < observer.mask.count ? i + 1 : 0;
+  double altitude = observer.mask.altitude[i] +
+		    (x - i) * (observer.mask.altitude[j] - observer.mask.altitude[i]);
+  return(s - maskThreshold(altitude));
+}
+
+// The sine of the altitude of the sun's centre when its upper limb appears
+// on terrain at an altitude in degrees.  Refraction falls off with altitude
+// as in Bennett's formula, scaled to agree with the horizon model on a level
+// horizon.  Below a degree under the horizon it is taken as constant.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR double
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::maskThreshold(double altitude) {
+  double h = altitude > -1 ? altitude : -1;
+  double x = M_PI / 180 * (h + 7.31 / (h + 4.4));
+  double x0 = M_PI / 180 * (7.31 / 4.4);
+  double ratio = Math::cos(x) / Math::sin(x) * Math::sin(x0) / Math::cos(x0);
+  return(Math::sin(M_PI / 180 * (altitude + 90 - Horizon::zenith() - 0.5667 * (ratio - 1))));
+}
+
+// Initialize the result for a query at time t.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::NearestEvents::start(time_t t) const {
+  sr->queryTime = t;
+  sr->riseTime = 0;
+  sr->setTime = 0;
+  sr->riseAz = 0;
+  sr->setAz = 0;
+  sr->hasRise = false;
+  sr->hasSet = false;
+  sr->isVisible = false;
+}
+
+// Record an event if it is nearer the query time than those already found.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::NearestEvents::event(bool rise,
+								    time_t eventTime,
+								    double az) const {
+  // If there is no previously recorded event of this type, save this event.
+  //
+  // If this event is previous to queryTime, and is the nearest event to queryTime
+  // of events of its type previous to queryType, save this event, replacing the
+  // previously recorded event of its type.  Events subsequent to queryTime are
+  // treated similarly, although since events are tested in chronological order
+  // no replacements will occur as successive events will be further from
+  // queryTime.
+  //
+  // If this event is subsequent to queryTime and there is an event of its type
+  // previous to queryTime, then there is an event of the other type between the
+  // two events of this event's type.  If the event of the other type is
+  // previous to queryTime, then it is the nearest event to queryTime that is
+  // previous to queryTime.  In this case save the current event, replacing
+  // the previously recorded event of its type.  Otherwise discard the current
+  // event.
+  //
+  time_t eventOffset = eventTime - sr->queryTime;
+  time_t riseOffset = sr->riseTime - sr->queryTime;
+  time_t setOffset = sr->setTime - sr->queryTime;
+  time_t eventDistance = eventOffset < 0 ? -eventOffset : eventOffset;
+
+  if (rise) {
+    if (!sr->hasRise ||
+	((riseOffset < 0) == (eventOffset < 0) &&
+	 (riseOffset < 0 ? -riseOffset : riseOffset) > eventDistance) ||
+	((riseOffset < 0) != (eventOffset < 0) &&
+	 (sr->hasSet &&
+	  (riseOffset < 0) == (setOffset < 0)))) {
+      sr->riseTime = eventTime;
+      sr->riseAz = az;
+      sr->hasRise = true;
+    }
+  } else {
+    if (!sr->hasSet ||
+	((setOffset < 0) == (eventOffset < 0) &&
+	 (setOffset < 0 ? -setOffset : setOffset) > eventDistance) ||
+	((setOffset < 0) != (eventOffset < 0) &&
+	 (sr->hasRise &&
+	  (setOffset < 0) == (riseOffset < 0)))) {
+      sr->setTime = eventTime;
+      sr->setAz = az;
+      sr->hasSet = true;
+    }
+  }
+}
+
+// Set isVisible once the window has been searched, given the altitude test
+// value at its end.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::NearestEvents::finish(double altitude) const {
+  // There are obscure cases in the polar regions that require extra logic.
+  if (!sr->hasRise && !sr->hasSet)
+    sr->isVisible = !(altitude < 0);
+  else if (sr->hasRise && !sr->hasSet)
+    sr->isVisible = (sr->queryTime > sr->riseTime);
+  else if (!sr->hasRise && sr->hasSet)
+    sr->isVisible = (sr->queryTime < sr->setTime);
+  else
+    sr->isVisible = ((sr->riseTime < sr->setTime && sr->riseTime < sr->queryTime &&
+		      sr->setTime > sr->queryTime) ||
+		     (sr->riseTime > sr->setTime &&
+		      (sr->riseTime < sr->queryTime || sr->setTime > sr->queryTime)));
+}
+
+// Record an event if it is the first of its type.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::FirstEvents::event(bool rise,
+								  time_t eventTime,
+								  double az) const {
+  if (rise && !sr->hasRise) {
+    sr->riseTime = eventTime;
+    sr->riseAz = az;
+    sr->hasRise = true;
+  } else if (!rise && !sr->hasSet) {
+    sr->setTime = eventTime;
+    sr->setAz = az;
+    sr->hasSet = true;
+  }
+}
+
+// Set isVisible for the start of the window: the sun was up if the first
+// event is a set, or, with no events, if it is up at the end.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::FirstEvents::finish(double altitude) const {
+  if (!sr->hasRise && !sr->hasSet)
+    sr->isVisible = !(altitude < 0);
+  else
+    sr->isVisible = sr->hasSet && (!sr->hasRise || sr->setTime < sr->riseTime);
+}
+
+// Sun position using fundamental arguments
+// (Van Flandern & Pulkkinen, 1979)
+template <class Math>
+SR_CONSTEXPR SunRiseCoordinates
+SunRiseSeries<Math>::position(double dayOffset) {
+  double centuryOffset = dayOffset / 36525 + 1;	      // Centuries from 1900.0
+
+  double l = 0.779072 + 0.00273790931 * dayOffset;
+  double g = 0.993126 + 0.00273777850 * dayOffset;
+
+  l = 2 * M_PI * (l - Math::floor(l));
+  g = 2 * M_PI * (g - Math::floor(g));
+
+  double v = 0.39785 * Math::sin(l)
+    - 0.01000 * Math::sin(l - g)
+    + 0.00333 * Math::sin(l + g)
+    - 0.00021 * centuryOffset * Math::sin(l);
+
+  double u = 1
+    - 0.03349 * Math::cos(g)
+    - 0.00014 * Math::cos(2*l)
+    + 0.00008 * Math::cos(l);
+
+  double w = -0.00010
+     - 0.04129 * Math::sin(2*l)
+     + 0.03211 * Math::sin(g)
+     + 0.00104 * Math::sin(2*l - g)
+     - 0.00035 * Math::sin(2*l + g)
+     - 0.00008 * centuryOffset * Math::sin(g);
+
+  SunRiseCoordinates sc = {};
+  double s = w / Math::sqrt(u - v*v);		    // Right ascension
+  sc.RA = l + Math::atan(s / Math::sqrt(1 - s*s));
+
+  s = v / Math::sqrt(u);			    // Declination
+  sc.declination = Math::atan(s / Math::sqrt(1 - s*s));
+  return(sc);
+}
+
+// The body's position from the ephemeris.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR SunRiseCoordinates
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::position(double dayOffset) {
+  return(Ephemeris::position(dayOffset));
+}
+
+// 3-point interpolation
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR double
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::interpolate(double f0, double f1, double f2, double p) {
+    double a = f1 - f0;
+    double b = f2 - f1 - a;
+    return(f0 + p * (2*a + b * (2*p - 1)));
+}
+
+// Prepare n values evenly spaced over [0, 1] for interpolation.  Three values
+// are used by the quadratic above as they are; otherwise they are replaced by
+// the coefficients of Newton's divided difference formula, so that each
+// interpolation costs only n - 1 multiplications.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR void
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::prepare(double *f, int n) {
+  if (n == 3)
+    return;
+  for (int k = 1; k < n; k++)
+    for (int i = n - 1; i >= k; i--)
+      f[i] = (f[i] - f[i - 1]) * (n - 1) / k;
+}
+
+// Interpolate at p in n values prepared by prepare().
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR double
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::interpolate(const double *f, int n, double p) {
+  if (n == 3)
+    return(interpolate(f[0], f[1], f[2], p));
+
+  double sum = f[n - 1];
+  for (int i = n - 2; i >= 0; i--)
+    sum = sum * (p - (double)i / (n - 1)) + f[i];
+  return(sum);
+}
+
+// Determine Julian date from Unix time.
+// Provides marginally accurate results with Arduino 4-byte double.
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR double
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::julianDate(time_t t) {
+  return (t / 86400.0L + 2440587.5);
+}
+
+// Local Sidereal Time
+// Provides local sidereal time in degrees, requires longitude in degrees
+// and time in fractional Julian days since Jan 1, 2000, 1200UTC (e.g. the
+// Julian date - 2451545).
+// cf. USNO Astronomical Almanac and
+// https://astronomy.stackexchange.com/questions/24859/local-sidereal-time
+template <class Math, class Ephemeris, class Grid, class Horizon>
+SR_CONSTEXPR double
+SunRiseKernel<Math, Ephemeris, Grid, Horizon>::localSiderealTime(double offsetDays, double longitude) {
+  double lSideTime = (15.0L * (6.697374558L + 0.06570982441908L * offsetDays +
+			       Math::remainder(offsetDays, 1) * 24 + 12 +
+			       0.000026 * (offsetDays / 36525) * (offsetDays / 36525))
+		      + longitude) / 360;
+  lSideTime -= Math::floor(lSideTime);
+  lSideTime *= 360;			  // Convert to degrees.
+  return(lSideTime);
+}
+
+#if __cplusplus >= 201402L
+// Sun rise/set events computed at compile time.
+constexpr SunRise
+sunRiseAt(double latitude, double longitude, time_t t) {
+  SunRise sr = {};
+  SunRiseKernel<SunRiseConstMath>::calculate(&sr, latitude, longitude, t);
+  return(sr);
+}
+#endif
+#endif
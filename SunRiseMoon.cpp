@@ -0,0 +1,87 @@
+// Moon rise/set calculation.
+//
+// Copyright 2020 Cyrus Rahman
+// You may use or modify this source code in any way you find useful, provided
+// that you agree that the author(s) have no warranty, obligations or liability.  You
+// must determine the suitability of this source code for your use.
+//
+// Redistributions of this source code must retain this copyright notice.
+
+#include <math.h>
+#include "SunRiseMoon.h"
+#include "SunRiseKernel.h"
+
+// Moon position using fundamental arguments
+// (Van Flandern & Pulkkinen, 1979)
+SunRiseCoordinates
+SunRiseMoonEphemeris::position(double dayOffset) {
+  double l = 0.606434 + 0.03660110129 * dayOffset;    // Mean longitude
+  double m = 0.374897 + 0.03629164709 * dayOffset;    // Mean anomaly
+  double f = 0.259091 + 0.03674819520 * dayOffset;    // Argument of latitude
+  double d = 0.827362 + 0.03386319198 * dayOffset;    // Mean elongation
+  double n = 0.347343 - 0.00014709391 * dayOffset;    // Longitude of node
+  double g = 0.993126 + 0.00273777850 * dayOffset;    // Sun's mean anomaly
+
+  l = 2 * M_PI * (l - floor(l));
+  m = 2 * M_PI * (m - floor(m));
+  f = 2 * M_PI * (f - floor(f));
+  d = 2 * M_PI * (d - floor(d));
+  n = 2 * M_PI * (n - floor(n));
+  g = 2 * M_PI * (g - floor(g));
+
+  double v = 0.39558 * sin(f + n)
+    + 0.08200 * sin(f)
+    + 0.03257 * sin(m - f - n)
+    + 0.01092 * sin(m + f + n)
+    + 0.00666 * sin(m - f)
+    - 0.00644 * sin(m + f - 2*d + n)
+    - 0.00331 * sin(f - 2*d + n)
+    - 0.00304 * sin(f - 2*d)
+    - 0.00240 * sin(m - f - 2*d - n)
+    + 0.00226 * sin(m + f)
+    - 0.00108 * sin(m + f - 2*d)
+    - 0.00079 * sin(f - n)
+    + 0.00078 * sin(f + 2*d + n);
+
+  double u = 1
+    - 0.10828 * cos(m)
+    - 0.01880 * cos(m - 2*d)
+    - 0.01479 * cos(2*d)
+    + 0.00181 * cos(2*m - 2*d)
+    - 0.00147 * cos(2*m)
+    - 0.00105 * cos(2*d - g)
+    - 0.00075 * cos(m - 2*d + g);
+
+  double w = 0.10478 * sin(m)
+    - 0.04105 * sin(2*f + 2*n)
+    - 0.02130 * sin(m - 2*d)
+    - 0.01779 * sin(2*f + n)
+    + 0.01774 * sin(n)
+    + 0.00987 * sin(2*d)
+    - 0.00338 * sin(m - 2*f - 2*n)
+    - 0.00309 * sin(g)
+    - 0.00190 * sin(2*f)
+    - 0.00144 * sin(m + n)
+    - 0.00144 * sin(m - 2*f - n)
+    - 0.00113 * sin(m + 2*f + 2*n)
+    - 0.00094 * sin(m - 2*d + g)
+    - 0.00092 * sin(2*m - 2*d);
+
+  SunRiseCoordinates sc = {};
+  double s = w / sqrt(u - v*v);			    // Right ascension
+  sc.RA = l + atan(s / sqrt(1 - s*s));
+  sc.RA -= 2 * M_PI * floor(sc.RA / (2 * M_PI));
+
+  s = v / sqrt(u);				    // Declination
+  sc.declination = atan(s / sqrt(1 - s*s));
+  return(sc);
+}
+
+// Determine the nearest moon rise or set event previous, and the nearest
+// moon rise or set event subsequent, to the specified time, as
+// SunRise::calculate() does for the sun.
+void
+SunRiseMoon::calculate(double latitude, double longitude, time_t t) {
+  SunRiseKernel<SunRiseLibMath, SunRiseMoonEphemeris, SunRiseGrid<SR_WINDOW, SR_STEP, 5>,
+		SunRiseMoonHorizon>::calculate(this, latitude, longitude, t);
+}
@@ -0,0 +1,38 @@
+#ifndef SunRiseMoon_h
+#define SunRiseMoon_h
+
+// Moon rise/set, found by the same search as the sun's.
+//
+// The moon's position is taken from the Van Flandern & Pulkkinen series for
+// the moon, as in Sinnott's companion moon rise program.  Since the moon
+// moves about thirteen degrees a day against the stars, its position is
+// interpolated through five points across the search window rather than
+// three.  The results are returned in the same form as the sun's: riseTime,
+// setTime, riseAz and setAz are the moon's, and isVisible tells whether the
+// moon is above the horizon at the query time.
+//
+//	SunRiseMoon mr;
+//	mr.calculate(latitude, longitude, t);
+//
+// Events are within a few minutes of more exact calculations.
+
+#include "SunRise.h"
+#include "SunRiseKernel.h"
+
+// The moon's geocentric position, as an ephemeris for SunRiseKernel.
+struct SunRiseMoonEphemeris {
+  static SunRiseCoordinates position(double dayOffset);
+};
+
+// The moon's horizon: its mean parallax of 0.95 degrees, less refraction and
+// its semidiameter, puts its centre 0.125 degrees above the horizon at rise and
+// set.
+struct SunRiseMoonHorizon {
+  static SR_CONSTEXPR double zenith() { return(89.875); }
+};
+
+class SunRiseMoon : public SunRise {
+  public:
+    void calculate(double latitude, double longitude, time_t t);
+};
+#endif
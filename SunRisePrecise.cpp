@@ -0,0 +1,193 @@
+// Sun rise/set calculation using the sun's position from VSOP87.
+//
+// Copyright 2020 Cyrus Rahman
+// You may use or modify this source code in any way you find useful, provided
+// that you agree that the author(s) have no warranty, obligations or liability.  You
+// must determine the suitability of this source code for your use.
+//
+// Redistributions of this source code must retain this copyright notice.
+
+#include <math.h>
+#include "SunRisePrecise.h"
+#include "SunRiseKernel.h"
+
+// A periodic term of the Earth's heliocentric coordinates: the amplitude, in
+// units of 1e-8 radian (or AU), times the cosine of phase + frequency * tau,
+// tau in Julian millennia from J2000.0.
+struct SunRiseTerm {
+  double amplitude;
+  double phase;
+  double frequency;
+};
+
+#define TERMS(t)    (int)(sizeof(t) / sizeof(t[0]))
+
+// Heliocentric longitude.
+static const SunRiseTerm L0[] = {
+  { 175347046, 0, 0 }, { 3341656, 4.6692568, 6283.07585 },
+  { 34894, 4.6261, 12566.1517 }, { 3497, 2.7441, 5753.3849 },
+  { 3418, 2.8289, 3.5231 }, { 3136, 3.6277, 77713.7715 },
+  { 2676, 4.4181, 7860.4194 }, { 2343, 6.1352, 3930.2097 },
+  { 1324, 0.7425, 11506.7698 }, { 1273, 2.0371, 529.691 },
+  { 1199, 1.1096, 1577.3435 }, { 990, 5.233, 5884.927 },
+  { 902, 2.045, 26.298 }, { 857, 3.508, 398.149 },
+  { 780, 1.179, 5223.694 }, { 753, 2.533, 5507.553 },
+  { 505, 4.583, 18849.228 }, { 492, 4.205, 775.523 },
+  { 357, 2.92, 0.067 }, { 317, 5.849, 11790.629 },
+  { 284, 1.899, 796.298 }, { 271, 0.315, 10977.079 },
+  { 243, 0.345, 5486.778 }, { 206, 4.806, 2544.314 },
+  { 205, 1.869, 5573.143 }, { 202, 2.458, 6069.777 },
+  { 156, 0.833, 213.299 }, { 132, 3.411, 2942.463 },
+  { 126, 1.083, 20.775 }, { 115, 0.645, 0.98 },
+  { 103, 0.636, 4694.003 }, { 102, 0.976, 15720.839 },
+  { 102, 4.267, 7.114 }, { 99, 6.21, 2146.17 },
+  { 98, 0.68, 155.42 }, { 86, 5.98, 161000.69 },
+  { 85, 1.3, 6275.96 }, { 85, 3.67, 71430.7 },
+  { 80, 1.81, 17260.15 }, { 79, 3.04, 12036.46 },
+  { 75, 1.76, 5088.63 }, { 74, 3.5, 3154.69 },
+  { 74, 4.68, 801.82 }, { 70, 0.83, 9437.76 },
+  { 62, 3.98, 8827.39 }, { 61, 1.82, 7084.9 },
+  { 57, 2.78, 6286.6 }, { 56, 4.39, 14143.5 },
+  { 56, 3.47, 6279.55 }, { 52, 0.19, 12139.55 },
+  { 52, 1.33, 1748.02 }, { 51, 0.28, 5856.48 },
+  { 49, 0.49, 1194.45 }, { 41, 5.37, 8429.24 },
+  { 41, 2.4, 19651.05 }, { 39, 6.17, 10447.39 },
+  { 37, 6.04, 10213.29 }, { 37, 2.57, 1059.38 },
+  { 36, 1.71, 2352.87 }, { 36, 1.78, 6812.77 },
+  { 33, 0.59, 17789.85 }, { 30, 0.44, 83996.85 },
+  { 30, 2.74, 1349.87 }, { 25, 3.16, 4690.48 },
+};
+
+static const SunRiseTerm L1[] = {
+  { 628331966747.0, 0, 0 }, { 206059, 2.678235, 6283.07585 },
+  { 4303, 2.6351, 12566.1517 }, { 425, 1.59, 3.523 },
+  { 119, 5.796, 26.298 }, { 109, 2.966, 1577.344 },
+  { 93, 2.59, 18849.23 }, { 72, 1.14, 529.69 },
+  { 68, 1.87, 398.15 }, { 67, 4.41, 5507.55 },
+  { 59, 2.89, 5223.69 }, { 56, 2.17, 155.42 },
+  { 45, 0.4, 796.3 }, { 36, 0.47, 775.52 },
+  { 29, 2.65, 7.11 }, { 21, 5.34, 0.98 },
+  { 19, 1.85, 5486.78 }, { 19, 4.97, 213.3 },
+  { 17, 2.99, 6275.96 }, { 16, 0.03, 2544.31 },
+  { 16, 1.43, 2146.17 }, { 15, 1.21, 10977.08 },
+  { 12, 2.83, 1748.02 }, { 12, 3.26, 5088.63 },
+  { 12, 5.27, 1194.45 }, { 12, 2.08, 4694 },
+  { 11, 0.77, 553.57 }, { 10, 1.3, 6286.6 },
+  { 10, 4.24, 1349.87 }, { 9, 2.7, 242.73 },
+  { 9, 5.64, 951.72 }, { 8, 5.3, 2352.87 },
+  { 6, 2.65, 9437.76 }, { 6, 4.67, 4690.48 },
+};
+
+static const SunRiseTerm L2[] = {
+  { 52919, 0, 0 }, { 8720, 1.0721, 6283.0758 },
+  { 309, 0.867, 12566.152 }, { 27, 0.05, 3.52 },
+  { 16, 5.19, 26.3 }, { 16, 3.68, 155.42 },
+  { 10, 0.76, 18849.23 }, { 9, 2.06, 77713.77 },
+  { 7, 0.83, 775.52 }, { 5, 4.66, 1577.34 },
+  { 4, 1.03, 7.11 }, { 4, 3.44, 5573.14 },
+  { 3, 5.14, 796.3 }, { 3, 6.05, 5507.55 },
+  { 3, 1.19, 242.73 }, { 3, 6.12, 529.69 },
+  { 3, 0.31, 398.15 }, { 3, 2.28, 553.57 },
+  { 2, 4.38, 5223.69 }, { 2, 3.75, 0.98 },
+};
+
+static const SunRiseTerm L3[] = {
+  { 289, 5.844, 6283.076 }, { 35, 0, 0 },
+  { 17, 5.49, 12566.15 }, { 3, 5.2, 155.42 },
+  { 1, 4.72, 3.52 }, { 1, 5.3, 18849.23 },
+  { 1, 5.97, 242.73 },
+};
+
+static const SunRiseTerm L4[] = {
+  { 114, 3.142, 0 }, { 8, 4.13, 6283.08 }, { 1, 3.84, 12566.15 },
+};
+
+static const SunRiseTerm L5[] = {
+  { 1, 3.14, 0 },
+};
+
+// Heliocentric latitude.
+static const SunRiseTerm B0[] = {
+  { 280, 3.199, 84334.662 }, { 102, 5.422, 5507.553 },
+  { 80, 3.88, 5223.69 }, { 44, 3.7, 2352.87 },
+  { 32, 4, 1577.34 },
+};
+
+static const SunRiseTerm B1[] = {
+  { 9, 3.9, 5507.55 }, { 6, 1.73, 5223.69 },
+};
+
+// Distance, needed only for the aberration, so only the largest terms.
+static const SunRiseTerm R0[] = {
+  { 100013989, 0, 0 }, { 1670700, 3.0984635, 6283.07585 },
+  { 13956, 3.05525, 12566.1517 }, { 3084, 5.1985, 77713.7715 },
+  { 1628, 1.1739, 5753.3849 }, { 1576, 2.8469, 7860.4194 },
+};
+
+static const SunRiseTerm R1[] = {
+  { 103019, 1.10749, 6283.07585 }, { 1721, 1.0644, 12566.1517 },
+};
+
+// Sum a series of terms.
+static double
+sum(const SunRiseTerm *terms, int n, double tau) {
+  double s = 0;
+  for (int i = 0; i < n; i++)
+    s += terms[i].amplitude * cos(terms[i].phase + terms[i].frequency * tau);
+  return(s);
+}
+
+// The sun's apparent position at a time in days since Jan 1, 2000, 1200UTC.
+SunRiseCoordinates
+SunRisePreciseEphemeris::position(double dayOffset) {
+  const double arcsecond = M_PI / (180 * 3600);
+  double t = (dayOffset + SR_DELTA_T / 86400) / 36525;	    // Julian centuries
+  double tau = t / 10;					    // Julian millennia
+
+  // The Earth's heliocentric longitude and latitude, reversed for the sun's
+  // geocentric ones, with the correction to the FK5 frame.
+  double l = (sum(L0, TERMS(L0), tau) +
+	      tau * (sum(L1, TERMS(L1), tau) +
+		     tau * (sum(L2, TERMS(L2), tau) +
+			    tau * (sum(L3, TERMS(L3), tau) +
+				   tau * (sum(L4, TERMS(L4), tau) +
+					  tau * sum(L5, TERMS(L5), tau)))))) / 1e8;
+  double b = (sum(B0, TERMS(B0), tau) + tau * sum(B1, TERMS(B1), tau)) / 1e8;
+  double r = (sum(R0, TERMS(R0), tau) + tau * sum(R1, TERMS(R1), tau)) / 1e8;
+  l += M_PI - 0.09033 * arcsecond;
+  b = -b;
+
+  // Nutation in longitude and obliquity, from the largest terms.
+  double omega = (125.04452 - 1934.136261 * t) * (M_PI / 180);
+  double sunMean = (280.4665 + 36000.7698 * t) * (M_PI / 180);
+  double moonMean = (218.3165 + 481267.8813 * t) * (M_PI / 180);
+  double dPsi = (-17.20 * sin(omega) - 1.32 * sin(2 * sunMean) -
+		 0.23 * sin(2 * moonMean) + 0.21 * sin(2 * omega)) * arcsecond;
+  double dEpsilon = (9.20 * cos(omega) + 0.57 * cos(2 * sunMean) +
+		     0.10 * cos(2 * moonMean) - 0.09 * cos(2 * omega)) * arcsecond;
+  double epsilon = (84381.448 - 46.8150 * t - 0.00059 * t * t + 0.001813 * t * t * t) *
+		   arcsecond + dEpsilon;
+
+  // Apparent longitude, with nutation and aberration.
+  double lambda = l + dPsi - 20.4898 * arcsecond / r;
+
+  SunRiseCoordinates sc;
+  double sinLambda = sin(lambda);
+  sc.RA = atan2(sinLambda * cos(epsilon) - tan(b) * sin(epsilon), cos(lambda)) -
+	  dPsi * cos(epsilon);
+  sc.RA -= 2 * M_PI * floor(sc.RA / (2 * M_PI));
+  sc.declination = asin(sin(b) * cos(epsilon) + cos(b) * sin(epsilon) * sinLambda);
+  return(sc);
+}
+
+// Determine the nearest sun rise or set event previous, and the nearest
+// sun rise or set event subsequent, to the specified time, as
+// SunRise::calculate() does.  The quadratic fitted to the sun's altitude over
+// each hour is itself out by up to a few seconds, so the altitude is tested
+// each half hour.  The three interpolated positions are fixed here, not taken
+// from SR_POINTS, so that tuning the library does not change the reference.
+void
+SunRisePrecise::calculate(double latitude, double longitude, time_t t) {
+  SunRiseKernel<SunRiseLibMath, SunRisePreciseEphemeris,
+		SunRiseGrid<SR_WINDOW, 30, 3> >::calculate(this, latitude, longitude, t);
+}
@@ -0,0 +1,43 @@
+#ifndef SunRisePrecise_h
+#define SunRisePrecise_h
+
+// Sun rise/set with the sun's position from the VSOP87 theory.
+//
+// The Van Flandern & Pulkkinen series used by SunRise::calculate() is good to
+// about a minute of arc, which moves events by up to a few seconds.
+// SunRisePrecise takes the sun's position instead from the terms of VSOP87
+// used by the NREL Solar Position Algorithm (Meeus, Astronomical Algorithms,
+// appendix III), with nutation and aberration, good to about a second of arc.
+// It searches as SunRise::calculate() does, but tests the sun's altitude each
+// half hour rather than each hour, and costs about three and a half times as much.
+// Since events also depend on refraction at the horizon, which varies with
+// the weather by more than this, it is for applications that compare with
+// other precise calculations rather than with what an observer sees.
+//
+//	SunRisePrecise sr;
+//	sr.calculate(latitude, longitude, t);
+//
+// Like the rest of the library, it requires eight byte doubles.
+
+#include "SunRise.h"
+#include "SunRiseKernel.h"
+
+// Terrestrial time less universal time, in seconds.  The sun's position is
+// calculated for terrestrial time; the difference was 69 seconds in 2020 and
+// changes by under a second a year.
+#ifndef SR_DELTA_T
+#define SR_DELTA_T  69.2
+#endif
+
+// The sun's apparent position, as an ephemeris for SunRiseKernel.  The right
+// ascension is reduced by the equation of the equinoxes, so that the kernel's
+// mean sidereal time gives the apparent hour angle.
+struct SunRisePreciseEphemeris {
+  static SunRiseCoordinates position(double dayOffset);
+};
+
+class SunRisePrecise : public SunRise {
+  public:
+    void calculate(double latitude, double longitude, time_t t);
+};
+#endif
@@ -0,0 +1,94 @@
+// Compute the day/night terminator and twilight boundaries for map overlays.
+//
+// Copyright 2020 Cyrus Rahman
+// You may use or modify this source code in any way you find useful, provided
+// that you agree that the author(s) have no warranty, obligations or liability.  You
+// must determine the suitability of this source code for your use.
+//
+// Redistributions of this source code must retain this copyright notice.
+
+#include <math.h>
+#include "SunTerminator.h"
+#include "SunRiseKernel.h"
+
+// Find the point at which the sun is overhead at the specified time in seconds
+// since the Unix epoch.
+void
+SunTerminator::calculate(time_t t) {
+  typedef SunRiseKernel<SunRiseLibMath> Kernel;
+  double offsetDays = Kernel::julianDate(t) - 2451545L;
+  SunRiseCoordinates sc = Kernel::position(offsetDays);
+
+  // The sun is overhead where the local sidereal time equals its right
+  // ascension.
+  double longitude = sc.RA * 180 / M_PI - Kernel::localSiderealTime(offsetDays, 0);
+  longitude -= 360 * floor((longitude + 180) / 360);
+
+  subsolarLatitude = sc.declination * 180 / M_PI;
+  subsolarLongitude = longitude;
+}
+
+// Trace the boundary at which the sun stands at the specified altitude in
+// degrees: a circle about the antisolar point.  The given number of points
+// are stored in order around the circle, with longitudes from -180 to 180.
+// Returns the number of points stored.
+int
+SunTerminator::boundary(double altitude, int points, double *latitudes,
+			double *longitudes) const {
+  double lat0 = -subsolarLatitude * M_PI / 180;		    // Antisolar point
+  double lon0 = subsolarLongitude * M_PI / 180 + M_PI;
+  double d = (90 + altitude) * M_PI / 180;		    // Radius of dark region
+
+  for (int i = 0; i < points; i++) {
+    double bearing = 2 * M_PI * i / points;
+    double lat = asin(sin(lat0) * cos(d) + cos(lat0) * sin(d) * cos(bearing));
+    double lon = lon0 + atan2(sin(bearing) * sin(d) * cos(lat0),
+			      cos(d) - sin(lat0) * sin(lat));
+
+    latitudes[i] = lat * 180 / M_PI;
+    lon = lon * 180 / M_PI;
+    longitudes[i] = lon - 360 * floor((lon + 180) / 360);
+  }
+  return(points);
+}
+
+// Return 1 if the region in which the sun is below the specified altitude
+// contains the north pole, -1 if it contains the south pole, 0 if neither
+// and 2 if both.
+int
+SunTerminator::darkPole(double altitude) const {
+  // The dark region is a circle of radius 90 + altitude degrees about the
+  // antisolar point, which is 90 + or - the declination from each pole.
+  bool north = subsolarLatitude < altitude;
+  bool south = -subsolarLatitude < altitude;
+  return(north && south ? 2 : (north ? 1 : (south ? -1 : 0)));
+}
+
+// Produce the region in which the sun is below the specified altitude as a
+// polygon for an equirectangular map.  Longitudes are continuous rather than
+// wrapped, and may run past 180; draw the polygon again shifted by 360 degrees
+// to cover the map.  When the region contains one pole the boundary crosses
+// every meridian, and the polygon is closed along that pole with two more
+// points.  The arrays must hold points + 2 values.  Returns the number of
+// points stored.
+int
+SunTerminator::polygon(double altitude, int points, double *latitudes,
+		       double *longitudes) const {
+  int pole = darkPole(altitude);
+
+  boundary(altitude, points, latitudes, longitudes);
+  for (int i = 1; i < points; i++) {
+    while (longitudes[i] - longitudes[i - 1] > 180)
+      longitudes[i] -= 360;
+    while (longitudes[i] - longitudes[i - 1] < -180)
+      longitudes[i] += 360;
+  }
+  if (pole != 1 && pole != -1)
+    return(points);
+
+  latitudes[points] = 90 * pole;
+  longitudes[points] = longitudes[points - 1];
+  latitudes[points + 1] = 90 * pole;
+  longitudes[points + 1] = longitudes[0];
+  return(points + 2);
+}
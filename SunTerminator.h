@@ -0,0 +1,28 @@
+#ifndef SunTerminator_h
+#define SunTerminator_h
+
+#include <time.h>
+
+// Sun altitudes, in degrees, of the boundaries usually drawn on maps.
+#define SR_SUNRISE_ALTITUDE	    -0.833  // Refraction + sun semidiameter.
+#define SR_CIVIL_TWILIGHT	    -6
+#define SR_NAUTICAL_TWILIGHT	    -12
+#define SR_ASTRONOMICAL_TWILIGHT    -18
+
+// The day/night terminator and twilight boundaries at a given time.
+//
+// The subsolar point is found from the sun's position and the sidereal time
+// at Greenwich; each boundary is then the circle of points at which the sun
+// stands at a given altitude, traced directly at the requested resolution.
+
+class SunTerminator {
+  public:
+    double subsolarLatitude;	    // Degrees
+    double subsolarLongitude;	    // Degrees, -180 to 180
+
+    void calculate(time_t t);
+    int boundary(double altitude, int points, double *latitudes, double *longitudes) const;
+    int polygon(double altitude, int points, double *latitudes, double *longitudes) const;
+    int darkPole(double altitude) const;
+};
+#endif
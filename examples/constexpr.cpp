@@ -0,0 +1,31 @@
+/*
+ * Compute sun rise/set events at compile time, demonstrating the constexpr
+ * kernel.  Requires C++14:
+ *
+ *	g++ -std=c++14 -I.. constexpr.cpp ../SunRise.cpp
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "SunRiseKernel.h"
+
+// Events at latitude 42, longitude -90, around 2023-11-14 22:13:20 UTC.
+constexpr SunRise sr = sunRiseAt(42, -90, 1700000000);
+
+// These checks are made by the compiler.
+static_assert(sr.hasRise && sr.hasSet, "events expected at mid latitudes");
+static_assert(sr.riseTime < sr.queryTime && sr.setTime > sr.queryTime,
+	      "query time lies between sun rise and sun set");
+static_assert(sr.isVisible, "sun is up between rise and set");
+
+int
+main(int argc, char *argv[]) {
+  SunRise rt;
+  rt.calculate(42, -90, 1700000000);
+
+  printf("compile time: rise %ld az %.2f, set %ld az %.2f\n",
+	 (long)sr.riseTime, sr.riseAz, (long)sr.setTime, sr.setAz);
+  printf("run time:     rise %ld az %.2f, set %ld az %.2f\n",
+	 (long)rt.riseTime, rt.riseAz, (long)rt.setTime, rt.setAz);
+}
@@ -0,0 +1,90 @@
+// Bulk daylight test by dot products of site and sun vectors.
+//
+// Copyright 2020 Cyrus Rahman
+// You may use or modify this source code in any way you find useful, provided
+// that you agree that the author(s) have no warranty, obligations or liability.  You
+// must determine the suitability of this source code for your use.
+//
+// Redistributions of this source code must retain this copyright notice.
+
+#include <math.h>
+#include "SunDaylight.h"
+#include "SunRiseKernel.h"
+
+typedef SunRiseKernel<SunRiseLibMath> Kernel;
+
+// Lowerings smaller than this, in the sine of the altitude (about 0.2 arc
+// seconds), are rounding noise from conditions that are standard or nearly
+// so, and are taken as none.
+#define SR_DAYLIGHT_LOWERING	1e-6
+
+// Add a site at a latitude and longitude in degrees.  Returns the site's
+// number, which is its bit in the results of query().
+size_t
+SunDaylight::addSite(double latitude, double longitude) {
+  double lat = latitude * M_PI / 180, lon = longitude * M_PI / 180;
+
+  x.push_back(cos(lat) * cos(lon));
+  y.push_back(cos(lat) * sin(lon));
+  z.push_back(sin(lat));
+  if (!lowered.empty())
+    lowered.push_back(0);
+  return(x.size() - 1);
+}
+
+// Add a site as above, for an observer in the given conditions.  The sun is
+// then tested against the horizon lowered (or raised) by as much as
+// SunRise::calculate() with the same conditions lowers its horizon.  Until
+// a site has been added with conditions, there are no lowerings to scan.
+size_t
+SunDaylight::addSite(double latitude, double longitude, const SunRiseConditions &conditions) {
+  size_t site = addSite(latitude, longitude);
+  double lowering = Kernel::site(0, 0).horizon - Kernel::horizon(conditions);
+
+  if (fabs(lowering) < SR_DAYLIGHT_LOWERING)
+    lowering = 0;
+  if (lowering != 0 && lowered.empty())
+    lowered.assign(x.size(), 0);
+  if (!lowered.empty())
+    lowered[site] = lowering;
+  return(site);
+}
+
+// Set bit n of the result for each site n at which the sun is above the
+// specified altitude in degrees at time t.  By default this is the altitude
+// used by SunRise for sun rise and set, so the result agrees with
+// SunRise::isVisible except within a few seconds of an event.
+void
+SunDaylight::query(time_t t, std::vector<uint64_t> *daylight, double altitude) const {
+  SunTerminator st;
+  st.calculate(t);
+
+  double lat = st.subsolarLatitude * M_PI / 180, lon = st.subsolarLongitude * M_PI / 180;
+  const float sx = cos(lat) * cos(lon), sy = cos(lat) * sin(lon), sz = sin(lat);
+  const float threshold = sin(altitude * M_PI / 180);
+  size_t n = x.size();
+  const float *px = x.data(), *py = y.data(), *pz = z.data();
+  const float *pl = lowered.empty() ? NULL : lowered.data();
+
+  daylight->assign((n + 63) / 64, 0);
+  uint64_t *out = daylight->data();
+
+  for (size_t base = 0; base < n; base += 64) {
+    size_t count = n - base < 64 ? n - base : 64;
+    uint64_t word = 0;
+
+    // Kept branch free so the compiler can vectorize it.
+    if (pl == NULL) {
+      for (size_t j = 0; j < count; j++) {
+	float s = px[base + j] * sx + py[base + j] * sy + pz[base + j] * sz;
+	word |= (uint64_t)(s > threshold) << j;
+      }
+    } else {
+      for (size_t j = 0; j < count; j++) {
+	float s = px[base + j] * sx + py[base + j] * sy + pz[base + j] * sz;
+	word |= (uint64_t)(s > threshold - pl[base + j]) << j;
+      }
+    }
+    out[base / 64] = word;
+  }
+}
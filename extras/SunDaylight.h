@@ -0,0 +1,44 @@
+#ifndef SunDaylight_h
+#define SunDaylight_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+
+#include "SunRise.h"
+#include "SunTerminator.h"
+
+// Determine which of a large number of sites are in daylight at a time.
+//
+// Each site is stored once as an Earth-fixed unit vector.  A query computes
+// the direction of the sun once, from the subsolar point, and the sun's
+// altitude at every site is then given by a dot product: the sine of the
+// altitude is the dot product of the site and sun vectors.  The scan is over
+// three arrays of floats and vectorizes, so it is limited by memory bandwidth
+// rather than by trigonometry.  The lowering of the horizon for a site's
+// height and weather is found when it is added, and is only subtracted from
+// the threshold in the scan; while no site has one, it is not read at all.
+//
+// This is host side code; it uses the standard library and is not part of the
+// Arduino library build.
+
+class SunDaylight {
+  public:
+    size_t addSite(double latitude, double longitude);
+    size_t addSite(double latitude, double longitude, const SunRiseConditions &conditions);
+    size_t sites() const { return(x.size()); }
+
+    void query(time_t t, std::vector<uint64_t> *daylight,
+	       double altitude = SR_SUNRISE_ALTITUDE) const;
+
+    static bool test(const std::vector<uint64_t> &daylight, size_t site) {
+      return((daylight[site / 64] >> (site % 64)) & 1);
+    }
+
+  private:
+    std::vector<float> x, y, z;
+    std::vector<float> lowered;		    // Sine of the horizon's lowering,
+					    // empty while all are 0.
+};
+#endif
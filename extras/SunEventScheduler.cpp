@@ -0,0 +1,226 @@
+// Hierarchical timing wheel scheduler for sun rise and set events.
+//
+// Sites are kept in a single array.  Each site is linked into exactly one wheel
+// slot by the index of the next site in that slot, so the wheel itself is a
+// fixed table of list heads and no allocation takes place after a site has
+// been added.
+//
+// An event at time t is placed on the lowest wheel level whose slot width
+// still distinguishes t from the current time.  As the current time enters the
+// period covered by a higher level slot that slot is cascaded, redistributing
+// its sites onto the lower levels, until they reach level 0 and fire.
+//
+// Copyright 2020 Cyrus Rahman
+// You may use or modify this source code in any way you find useful, provided
+// that you agree that the author(s) have no warranty, obligations or liability.  You
+// must determine the suitability of this source code for your use.
+//
+// Redistributions of this source code must retain this copyright notice.
+
+#include <algorithm>
+
+#include "SunEventScheduler.h"
+#include "SunRiseKernel.h"
+
+#define SR_WHEEL_MASK	(SR_WHEEL_SLOTS - 1)
+
+// Longest interval searched for a following event.  The polar night is
+// shorter than this.
+#define SR_EVENT_LIMIT	(200 * 86400L)
+
+SunEventScheduler::SunEventScheduler(time_t start, Callback callback, void *context)
+  : current(start), pendingCount(0), callback(callback), context(context) {
+  for (int l = 0; l < SR_WHEEL_LEVELS; l++)
+    for (int i = 0; i < SR_WHEEL_SLOTS; i++)
+      wheel[l][i] = -1;
+}
+
+// Add a site and schedule its first event of the given kind after the current
+// time.  Returns the site number passed to the callback; a location with more
+// than one kind of event is added once for each.
+size_t
+SunEventScheduler::addSite(double latitude, double longitude, Kind kind) {
+  Site s;
+  s.latitude = latitude;
+  s.longitude = longitude;
+  s.eventTime = current;
+  s.azimuth = 0;
+  s.type = riseEvent;
+  s.kind = kind;
+  s.next = -1;
+  sites.push_back(s);
+  schedule(sites.size() - 1);
+  return(sites.size() - 1);
+}
+
+// Search for the nearest events of a kind.
+static void
+search(SunRise *sr, double latitude, double longitude, time_t t,
+       SunEventScheduler::Kind kind) {
+  typedef SunRiseSeries<SunRiseLibMath> Series;
+
+  switch (kind) {
+  case SunEventScheduler::civilTwilight:
+    SunRiseKernel<SunRiseLibMath, Series, SunRiseGrid<>,
+		  SunRiseCivilTwilight>::calculate(sr, latitude, longitude, t);
+    break;
+  case SunEventScheduler::nauticalTwilight:
+    SunRiseKernel<SunRiseLibMath, Series, SunRiseGrid<>,
+		  SunRiseNauticalTwilight>::calculate(sr, latitude, longitude, t);
+    break;
+  case SunEventScheduler::astronomicalTwilight:
+    SunRiseKernel<SunRiseLibMath, Series, SunRiseGrid<>,
+		  SunRiseAstronomicalTwilight>::calculate(sr, latitude, longitude, t);
+    break;
+  default:
+    sr->calculate(latitude, longitude, t);
+  }
+}
+
+// Find the first event of a kind after the specified time.  Returns false if
+// there is none within SR_EVENT_LIMIT.
+bool
+SunEventScheduler::nextEvent(double latitude, double longitude, time_t after,
+			     EventType *type, time_t *eventTime, float *azimuth,
+			     Kind kind) {
+  SunRise sr;
+
+  for (time_t t = after; t - after < SR_EVENT_LIMIT; t += SR_WINDOW / 2 * 60 * 60) {
+    search(&sr, latitude, longitude, t, kind);
+    bool rise = sr.hasRise && sr.riseTime > after;
+    bool set = sr.hasSet && sr.setTime > after;
+
+    if (rise && (!set || sr.riseTime < sr.setTime)) {
+      *type = riseEvent;
+      *eventTime = sr.riseTime;
+      *azimuth = sr.riseAz;
+      return(true);
+    }
+    if (set) {
+      *type = setEvent;
+      *eventTime = sr.setTime;
+      *azimuth = sr.setAz;
+      return(true);
+    }
+  }
+  return(false);
+}
+
+// Look up the event following the site's last event and put it on the wheel.
+void
+SunEventScheduler::schedule(size_t site) {
+  Site *s = &sites[site];
+
+  if (!nextEvent(s->latitude, s->longitude, s->eventTime + SR_EVENT_GUARD,
+		 &s->type, &s->eventTime, &s->azimuth, s->kind))
+    return;				    // Site never sees the sun move again.
+  insert(site);
+  pendingCount++;
+}
+
+// Link a site into the slot for its event time.
+void
+SunEventScheduler::insert(size_t site) {
+  Site *s = &sites[site];
+  time_t when = s->eventTime < current ? current : s->eventTime;
+  unsigned long long diff = (unsigned long long)when ^ (unsigned long long)current;
+  int level = 0;
+
+  while (level < SR_WHEEL_LEVELS - 1 && (diff >> (SR_WHEEL_BITS * (level + 1))) != 0)
+    level++;
+
+  int slot = (when >> (SR_WHEEL_BITS * level)) & SR_WHEEL_MASK;
+  s->next = wheel[level][slot];
+  wheel[level][slot] = site;
+}
+
+// Redistribute the sites of the slot the current time has just entered.
+void
+SunEventScheduler::cascade(int level) {
+  int slot = (current >> (SR_WHEEL_BITS * level)) & SR_WHEEL_MASK;
+  long site = wheel[level][slot];
+
+  wheel[level][slot] = -1;
+  while (site >= 0) {
+    long next = sites[site].next;
+    insert(site);
+    site = next;
+  }
+}
+
+// Fire every event due at or before now, in time order, scheduling each
+// site's following event as its event fires.
+void
+SunEventScheduler::advance(time_t now) {
+  while (current <= now) {
+    int slot = current & SR_WHEEL_MASK;
+
+    // Entering a new period of a higher level: cascade from the top down so
+    // sites fall through every level they need to.
+    if (slot == 0) {
+      int top = 1;
+      while (top < SR_WHEEL_LEVELS - 1 &&
+	     ((current >> (SR_WHEEL_BITS * top)) & SR_WHEEL_MASK) == 0)
+	top++;
+      for (int l = top; l > 0; l--)
+	cascade(l);
+    }
+
+    // Callbacks may schedule into this slot, so drain it until empty.
+    while (wheel[0][slot] >= 0) {
+      long site = wheel[0][slot];
+      wheel[0][slot] = -1;
+      while (site >= 0) {
+	Site *s = &sites[site];
+	long next = s->next;
+	pendingCount--;
+	callback(context, site, s->type, s->eventTime, s->azimuth);
+	schedule(site);
+	site = next;
+      }
+    }
+    current = nextVisit(now + 1);
+  }
+}
+
+// The next time after the current time at which advance() has work to do,
+// or limit if that is sooner: the start of the first occupied slot on any
+// level, or the end of the top level's turn.  Sites on a level below the top
+// lie ahead of the current time within the turn of the level above, so the
+// slots of each level start after those of the levels below it, and the empty
+// slots passed over need no cascade.
+time_t
+SunEventScheduler::nextVisit(time_t limit) const {
+  for (int l = 0; l < SR_WHEEL_LEVELS; l++) {
+    int shift = SR_WHEEL_BITS * l;
+    time_t turn = current >> shift >> SR_WHEEL_BITS << SR_WHEEL_BITS;
+    for (int i = ((current >> shift) & SR_WHEEL_MASK) + 1; i < SR_WHEEL_SLOTS; i++) {
+      time_t start = (turn + i) << shift;
+      if (start >= limit)
+	return(limit);
+      if (wheel[l][i] >= 0)
+	return(start);
+    }
+  }
+  return(std::min(limit, ((current >> (SR_WHEEL_BITS * SR_WHEEL_LEVELS)) + 1)
+			 << (SR_WHEEL_BITS * SR_WHEEL_LEVELS)));
+}
+
+// Time of the earliest pending event, or -1 if there is none.  Suitable for
+// deciding how long to sleep before the next call to advance().
+time_t
+SunEventScheduler::nextDeadline() const {
+  for (int l = 0; l < SR_WHEEL_LEVELS; l++) {
+    int first = (current >> (SR_WHEEL_BITS * l)) & SR_WHEEL_MASK;
+    for (int i = (l == 0 ? first : first + 1); i < SR_WHEEL_SLOTS; i++) {
+      if (wheel[l][i] < 0)
+	continue;
+      time_t earliest = sites[wheel[l][i]].eventTime;
+      for (long site = wheel[l][i]; site >= 0; site = sites[site].next)
+	if (sites[site].eventTime < earliest)
+	  earliest = sites[site].eventTime;
+      return(earliest < current ? current : earliest);
+    }
+  }
+  return(-1);
+}
@@ -0,0 +1,71 @@
+#ifndef SunEventScheduler_h
+#define SunEventScheduler_h
+
+#include <stddef.h>
+#include <time.h>
+#include <vector>
+
+// Fire callbacks at the sun rise and set events, or the beginning and end of
+// twilight, of a large number of sites.
+//
+// Each site holds exactly one pending event in a hierarchical timing wheel.
+// Only when that event fires is the SunRise engine asked for the site's
+// following event, so the work done per second is proportional to the number
+// of events due rather than to the number of sites.
+//
+// This is host side code; it uses the standard library and is not part of the
+// Arduino library build.
+
+// Wheel geometry: SR_WHEEL_LEVELS levels of 2^SR_WHEEL_BITS one second slots.
+// Six levels of 64 slots cover 2^36 seconds, far beyond any event horizon.
+#define SR_WHEEL_BITS	6
+#define SR_WHEEL_SLOTS	(1 << SR_WHEEL_BITS)
+#define SR_WHEEL_LEVELS	6
+
+class SunEventScheduler {
+  public:
+    enum EventType { riseEvent, setEvent };
+
+    // The altitude of the sun at a site's events: rise and set, or the
+    // beginning (as a rise) and end (as a set) of a kind of twilight.
+    enum Kind { sunEvents, civilTwilight, nauticalTwilight, astronomicalTwilight };
+
+    typedef void (*Callback)(void *context, size_t site, EventType type,
+			     time_t eventTime, float azimuth);
+
+    SunEventScheduler(time_t start, Callback callback, void *context);
+
+    size_t addSite(double latitude, double longitude, Kind kind = sunEvents);
+    void advance(time_t now);
+    time_t nextDeadline() const;
+    time_t currentTime() const { return(current); }
+    size_t pending() const { return(pendingCount); }
+
+    static bool nextEvent(double latitude, double longitude, time_t after,
+			  EventType *type, time_t *eventTime, float *azimuth,
+			  Kind kind = sunEvents);
+
+  private:
+    struct Site {
+      double latitude;
+      double longitude;
+      time_t eventTime;
+      float azimuth;
+      EventType type;
+      Kind kind;
+      long next;		    // Next site in the same slot, or -1.
+    };
+
+    std::vector<Site> sites;
+    long wheel[SR_WHEEL_LEVELS][SR_WHEEL_SLOTS];
+    time_t current;
+    size_t pendingCount;
+    Callback callback;
+    void *context;
+
+    void schedule(size_t site);
+    void insert(size_t site);
+    void cascade(int level);
+    time_t nextVisit(time_t limit) const;
+};
+#endif
@@ -0,0 +1,205 @@
+// Delta-varint compressed series of daily sun rise and set events.
+//
+// Layout:
+//	"SRS1"
+//	varint zigzag(latitude * 1e6), zigzag(longitude * 1e6), zigzag(firstDay),
+//	       days, blockDays
+//	uint32 little endian offset of each block from the end of the index
+//	blocks
+//
+// Each day is a rise field, a set field and, after each field for an event
+// that exists, the varint zigzag difference of its azimuth.  A field is
+// (zigzag(difference in minutes) << 1) | 1 for an event, 2 for no event with
+// the sun up, or 0 for no event with the sun down.  Differences are taken from
+// the last event of the same type in the block.
+//
+// Copyright 2020 Cyrus Rahman
+// You may use or modify this source code in any way you find useful, provided
+// that you agree that the author(s) have no warranty, obligations or liability.  You
+// must determine the suitability of this source code for your use.
+//
+// Redistributions of this source code must retain this copyright notice.
+
+#include <math.h>
+#include <string.h>
+
+#include "SunEventSeries.h"
+#include "SunLocalDay.h"
+
+static void
+putVarint(std::vector<uint8_t> *out, uint64_t v) {
+  while (v >= 0x80) {
+    out->push_back((uint8_t)(v | 0x80));
+    v >>= 7;
+  }
+  out->push_back((uint8_t)v);
+}
+
+static bool
+getVarint(const uint8_t **p, const uint8_t *end, uint64_t *v) {
+  *v = 0;
+  for (int shift = 0; *p < end && shift < 64; shift += 7) {
+    uint8_t b = *(*p)++;
+    *v |= (uint64_t)(b & 0x7f) << shift;
+    if (!(b & 0x80))
+      return(true);
+  }
+  return(false);
+}
+
+static uint64_t
+zigzag(int64_t v) {
+  return(((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+static int64_t
+unzigzag(uint64_t v) {
+  return((int64_t)(v >> 1) ^ -(int64_t)(v & 1));
+}
+
+// Encode the events of the given number of days starting at firstDay, in
+// blocks of blockDays.  Returns false, leaving out empty, if either is not
+// positive.
+bool
+SunEventSeries::encode(double latitude, double longitude, long firstDay, long days,
+		       std::vector<uint8_t> *out, int blockDays) {
+  out->clear();
+  if (days <= 0 || blockDays <= 0)
+    return(false);
+
+  long microLat = lround(latitude * 1e6), microLon = lround(longitude * 1e6);
+  long blockCount = (days + blockDays - 1) / blockDays;
+  std::vector<uint8_t> body;
+  std::vector<uint32_t> offsets;
+  long prevRise = 0, prevSet = 0, prevRiseAz = 0, prevSetAz = 0;
+  SunRise sr;
+
+  // Calculate with the stored coordinates so decoding reproduces local noon.
+  latitude = microLat / 1e6;
+  longitude = microLon / 1e6;
+
+  for (long i = 0; i < days; i++) {
+    if (i % blockDays == 0) {
+      offsets.push_back(body.size());
+      prevRise = prevSet = prevRiseAz = prevSetAz = 0;
+    }
+
+    time_t noon = sunLocalNoon(firstDay + i, longitude);
+    sunLocalDayEvents(&sr, latitude, longitude, firstDay + i);
+
+    if (sr.hasRise) {
+      long minutes = lround((sr.riseTime - noon) / 60.0);
+      long az = lround(sr.riseAz * 100);
+      putVarint(&body, zigzag(minutes - prevRise) << 1 | 1);
+      putVarint(&body, zigzag(az - prevRiseAz));
+      prevRise = minutes;
+      prevRiseAz = az;
+    } else
+      putVarint(&body, sr.isVisible ? 2 : 0);
+
+    if (sr.hasSet) {
+      long minutes = lround((sr.setTime - noon) / 60.0);
+      long az = lround(sr.setAz * 100);
+      putVarint(&body, zigzag(minutes - prevSet) << 1 | 1);
+      putVarint(&body, zigzag(az - prevSetAz));
+      prevSet = minutes;
+      prevSetAz = az;
+    } else
+      putVarint(&body, sr.isVisible ? 2 : 0);
+  }
+
+  for (const char *m = "SRS1"; *m != '\0'; m++)
+    out->push_back(*m);
+  putVarint(out, zigzag(microLat));
+  putVarint(out, zigzag(microLon));
+  putVarint(out, zigzag(firstDay));
+  putVarint(out, days);
+  putVarint(out, blockDays);
+  for (long b = 0; b < blockCount; b++)
+    for (int k = 0; k < 4; k++)
+      out->push_back((uint8_t)(offsets[b] >> (8 * k)));
+  out->insert(out->end(), body.begin(), body.end());
+  return(true);
+}
+
+// Attach to an encoded series.  The data must remain valid while in use.
+// Returns false if it is not a valid series, or its index does not fit.
+bool
+SunEventSeries::open(const uint8_t *buffer, size_t len) {
+  const uint8_t *p = buffer, *end = buffer + len;
+  uint64_t v[5];
+
+  if (len < 4 || memcmp(p, "SRS1", 4) != 0)
+    return(false);
+  p += 4;
+  for (int i = 0; i < 5; i++)
+    if (!getVarint(&p, end, &v[i]))
+      return(false);
+  if (v[2] > 0xffffffff || v[3] == 0 || v[3] > 0x7fffffff || v[4] == 0 ||
+      v[4] > 0x7fffffff)
+    return(false);
+  lat = unzigzag(v[0]) / 1e6;
+  lon = unzigzag(v[1]) / 1e6;
+  first = unzigzag(v[2]);
+  count = (long)v[3];
+  blockDays = (long)v[4];
+  blockCount = (count + blockDays - 1) / blockDays;
+  if ((size_t)(end - p) / 4 < (size_t)blockCount)
+    return(false);
+
+  data = buffer;
+  length = len;
+  index = p;
+  blocks = p + blockCount * 4;
+  return(true);
+}
+
+// Decode one field and its azimuth, applying them to the running values.
+static bool
+getEvent(const uint8_t **p, const uint8_t *end, long *minutes, long *az,
+	 bool *has, bool *up) {
+  uint64_t field, delta;
+
+  if (!getVarint(p, end, &field))
+    return(false);
+  *has = field & 1;
+  *up = field == 2;
+  if (!*has)
+    return(true);
+  if (!getVarint(p, end, &delta))
+    return(false);
+  *minutes += unzigzag(field >> 1);
+  *az += unzigzag(delta);
+  return(true);
+}
+
+// Look up the events of day d.  Returns false if d is outside the series, or
+// its block is damaged.
+bool
+SunEventSeries::day(long d, Day *result) const {
+  if (d < first || d >= first + count)
+    return(false);
+
+  long i = d - first, b = i / blockDays;
+  uint32_t offset = index[4 * b] | index[4 * b + 1] << 8 |
+		    (uint32_t)index[4 * b + 2] << 16 | (uint32_t)index[4 * b + 3] << 24;
+  const uint8_t *end = data + length;
+  if (offset >= (size_t)(end - blocks))
+    return(false);
+  const uint8_t *p = blocks + offset;
+  long rise = 0, set = 0, riseAz = 0, setAz = 0;
+  bool riseUp = false, setUp = false;
+
+  for (long k = b * blockDays; k <= i; k++)
+    if (!getEvent(&p, end, &rise, &riseAz, &result->hasRise, &riseUp) ||
+	!getEvent(&p, end, &set, &setAz, &result->hasSet, &setUp))
+      return(false);
+
+  time_t noon = sunLocalNoon(d, lon);
+  result->riseTime = result->hasRise ? noon + rise * 60 : 0;
+  result->setTime = result->hasSet ? noon + set * 60 : 0;
+  result->riseAz = result->hasRise ? riseAz / 100.0 : 0;
+  result->setAz = result->hasSet ? setAz / 100.0 : 0;
+  result->upAllDay = !result->hasRise && !result->hasSet && riseUp;
+  return(true);
+}
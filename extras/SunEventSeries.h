@@ -0,0 +1,53 @@
+#ifndef SunEventSeries_h
+#define SunEventSeries_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+
+// Compressed series of daily sun rise and set events at one location.
+//
+// For each local mean day the first sun rise and the first sun set are stored,
+// as minutes from noon and azimuths in hundredths of a degree.  Each
+// value is stored as the zigzag varint of its difference from the previous
+// day, so a typical day takes four or five bytes.  Days are grouped into
+// blocks whose first day is stored in full; an index of block offsets gives
+// random access to any day by decoding at most one block.
+//
+// Days are numbered from the Unix epoch as by SunLocalDay.h (day 0 is January
+// 1, 1970).
+
+class SunEventSeries {
+  public:
+    struct Day {
+      time_t riseTime;		    // To the minute.
+      time_t setTime;
+      float riseAz;
+      float setAz;
+      bool hasRise;
+      bool hasSet;
+      bool upAllDay;		    // Sun up with no rise or set.
+    };
+
+    static bool encode(double latitude, double longitude, long firstDay, long days,
+		       std::vector<uint8_t> *out, int blockDays = 64);
+
+    bool open(const uint8_t *data, size_t length);
+    bool day(long d, Day *result) const;
+
+    double latitude() const { return(lat); }
+    double longitude() const { return(lon); }
+    long firstDay() const { return(first); }
+    long days() const { return(count); }
+
+  private:
+    const uint8_t *data;
+    const uint8_t *index;
+    const uint8_t *blocks;
+    size_t length;
+    double lat, lon;
+    long first, count;
+    long blockDays, blockCount;
+};
+#endif
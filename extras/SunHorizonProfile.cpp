@@ -0,0 +1,317 @@
+// Horizon profiles from a terrain grid, and their cache.
+//
+// Cache layout:
+//	"SRH1"
+//	varint azimuths, sites
+//	uint32 little endian offset of each site's record from the end of the index
+//	records
+//
+// A record is varint zigzag(latitude * 1e6), zigzag(longitude * 1e6), then
+// for each azimuth the varint zigzag difference of its altitude, in
+// hundredths of a degree, from the previous azimuth's (from 0 for the first).
+//
+// Copyright 2020 Cyrus Rahman
+// You may use or modify this source code in any way you find useful, provided
+// that you agree that the author(s) have no warranty, obligations or liability.  You
+// must determine the suitability of this source code for your use.
+//
+// Redistributions of this source code must retain this copyright notice.
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "SunHorizonProfile.h"
+
+#define EARTH_RADIUS	    6371000.0	    // Metres
+#define REFRACTION	    0.13	    // Terrestrial refraction coefficient
+#define STEP_GROWTH	    0.005	    // Of the distance, per step
+
+static void
+putVarint(std::vector<uint8_t> *out, uint64_t v) {
+  while (v >= 0x80) {
+    out->push_back((uint8_t)(v | 0x80));
+    v >>= 7;
+  }
+  out->push_back((uint8_t)v);
+}
+
+static bool
+getVarint(const uint8_t **p, const uint8_t *end, uint64_t *v) {
+  *v = 0;
+  for (int shift = 0; *p < end && shift < 64; shift += 7) {
+    uint8_t b = *(*p)++;
+    *v |= (uint64_t)(b & 0x7f) << shift;
+    if (!(b & 0x80))
+      return(true);
+  }
+  return(false);
+}
+
+static uint64_t
+zigzag(int64_t v) {
+  return(((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+static int64_t
+unzigzag(uint64_t v) {
+  return((int64_t)(v >> 1) ^ -(int64_t)(v & 1));
+}
+
+// The height at a point in grid coordinates, interpolated bilinearly.
+// Returns false outside the grid.
+static bool
+heightAt(const SunHorizonProfile::Elevation &dem, double x, double y, double *h) {
+  if (!(x >= 0 && y >= 0 && x <= dem.columns - 1 && y <= dem.rows - 1))
+    return(false);
+
+  int i = std::min((int)x, dem.columns - 2), j = std::min((int)y, dem.rows - 2);
+  double fx = x - i, fy = y - j;
+  const int16_t *p = dem.height + (size_t)j * dem.columns + i;
+  double top = p[0] + fx * (p[1] - p[0]);
+  double bottom = p[dem.columns] + fx * (p[dem.columns + 1] - p[dem.columns]);
+  *h = top + fy * (bottom - top);
+  return(true);
+}
+
+// The profile of one site.  Angles are compared as slopes until the end.
+// Returns false, leaving the profile level, if the site is outside the grid.
+static bool
+march(const SunHorizonProfile::Elevation &dem, double highest,
+      const SunHorizonProfile::Site &site, int azimuths, double range, float *altitude) {
+  double x0 = (site.longitude - dem.west) / dem.spacing;
+  double y0 = (dem.north - site.latitude) / dem.spacing;
+  double h0;
+
+  if (!heightAt(dem, x0, y0, &h0)) {
+    std::fill(altitude, altitude + azimuths, 0.0f);
+    return(false);
+  }
+  h0 += site.height;
+
+  double cellMetres = M_PI / 180 * dem.spacing * EARTH_RADIUS;
+  double perRow = 1 / cellMetres;
+  double perColumn = 1 / (cellMetres * cos(M_PI / 180 * site.latitude));
+  double drop = (1 - REFRACTION) / (2 * EARTH_RADIUS);	    // Per metre squared
+
+  for (int a = 0; a < azimuths; a++) {
+    double az = 2 * M_PI * a / azimuths;
+    double dx = sin(az) * perColumn, dy = -cos(az) * perRow;
+    double best = -HUGE_VAL;
+
+    for (double d = cellMetres / 2; d <= range;
+	 d += std::max(cellMetres / 2, d * STEP_GROWTH)) {
+      // No terrain further out can rise above the best slope so far.
+      double bound = (highest > h0 ? (highest - h0) / d : 0) - drop * d;
+      if (bound <= best)
+	break;
+
+      double h;
+      if (!heightAt(dem, x0 + d * dx, y0 + d * dy, &h))
+	break;
+      best = std::max(best, (h - h0) / d - drop * d);
+    }
+    altitude[a] = best == -HUGE_VAL ? 0 : (float)(180 / M_PI * atan(best));
+  }
+  return(true);
+}
+
+// Whether a site lies within the grid, and so can be given a profile.
+bool
+SunHorizonProfile::covers(const Elevation &dem, const Site &site) {
+  double h;
+  return(heightAt(dem, (site.longitude - dem.west) / dem.spacing,
+		  (dem.north - site.latitude) / dem.spacing, &h));
+}
+
+// Replace each void with the mean of the samples around it, working inwards
+// from the edges of the void.  Returns the number of voids filled; any left,
+// in a grid with no data at all, are set to 0.
+long
+SunHorizonProfile::fillVoids(int16_t *height, int columns, int rows) {
+  std::vector<size_t> voids, still;
+  std::vector<std::pair<size_t, int16_t> > filled;
+
+  for (size_t i = 0; i < (size_t)columns * rows; i++)
+    if (height[i] == SR_VOID_HEIGHT)
+      voids.push_back(i);
+  long count = (long)voids.size();
+
+  // Each pass fills the voids next to data, from the data before the pass.
+  while (!voids.empty()) {
+    still.clear();
+    filled.clear();
+    for (size_t v = 0; v < voids.size(); v++) {
+      int x = (int)(voids[v] % columns), y = (int)(voids[v] / columns);
+      long sum = 0;
+      int n = 0;
+      for (int j = std::max(y - 1, 0); j <= std::min(y + 1, rows - 1); j++)
+	for (int i = std::max(x - 1, 0); i <= std::min(x + 1, columns - 1); i++) {
+	  int16_t h = height[(size_t)j * columns + i];
+	  if (h != SR_VOID_HEIGHT) {
+	    sum += h;
+	    n++;
+	  }
+	}
+      if (n > 0)
+	filled.push_back(std::make_pair(voids[v], (int16_t)lround((double)sum / n)));
+      else
+	still.push_back(voids[v]);
+    }
+    if (filled.empty()) {
+      for (size_t v = 0; v < still.size(); v++)
+	height[still[v]] = 0;
+      break;
+    }
+    for (size_t f = 0; f < filled.size(); f++)
+      height[filled[f].first] = filled[f].second;
+    voids.swap(still);
+  }
+  return(count);
+}
+
+// Find the profile of each site, as the terrain's apparent altitude in
+// degrees at the given number of azimuths.  Terrain beyond range metres is
+// ignored.  Threads is the number of threads to use, or 0 for one per
+// processor.  The profiles are returned one after another in altitudes.
+// Returns the number of sites outside the grid, whose profiles are level.
+long
+SunHorizonProfile::compute(const Elevation &dem, const std::vector<Site> &sites,
+			   int azimuths, double range, int threads,
+			   std::vector<float> *altitudes) {
+  altitudes->assign(sites.size() * azimuths, 0.0f);
+  if (dem.columns < 2 || dem.rows < 2)
+    return((long)sites.size());
+
+  size_t samples = (size_t)dem.columns * dem.rows;
+  double highest = *std::max_element(dem.height, dem.height + samples);
+
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = (int)std::min((size_t)threads, std::max((size_t)1, sites.size()));
+
+  std::atomic<size_t> next(0);
+  std::atomic<long> outside(0);
+  auto work = [&]() {
+    for (size_t s; (s = next++) < sites.size(); )
+      if (!march(dem, highest, sites[s], azimuths, range, &(*altitudes)[s * azimuths]))
+	outside++;
+  };
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; t++)
+    pool.push_back(std::thread(work));
+  work();
+  for (size_t t = 0; t < pool.size(); t++)
+    pool[t].join();
+  return(outside);
+}
+
+// Encode the profiles found by compute() for the sites.
+void
+SunHorizonProfile::encode(const std::vector<Site> &sites, int azimuths,
+			  const std::vector<float> &altitudes, std::vector<uint8_t> *out) {
+  std::vector<uint8_t> body;
+  std::vector<uint32_t> offsets;
+
+  for (size_t s = 0; s < sites.size(); s++) {
+    offsets.push_back((uint32_t)body.size());
+    putVarint(&body, zigzag(lround(sites[s].latitude * 1e6)));
+    putVarint(&body, zigzag(lround(sites[s].longitude * 1e6)));
+    long previous = 0;
+    for (int a = 0; a < azimuths; a++) {
+      long centi = lround(altitudes[s * azimuths + a] * 100);
+      putVarint(&body, zigzag(centi - previous));
+      previous = centi;
+    }
+  }
+
+  out->clear();
+  for (const char *m = "SRH1"; *m != '\0'; m++)
+    out->push_back(*m);
+  putVarint(out, azimuths);
+  putVarint(out, sites.size());
+  for (size_t s = 0; s < offsets.size(); s++)
+    for (int k = 0; k < 4; k++)
+      out->push_back((uint8_t)(offsets[s] >> (8 * k)));
+  out->insert(out->end(), body.begin(), body.end());
+}
+
+// Attach to an encoded cache.  The data must remain valid while in use.
+// Returns false if it is not a valid cache.
+bool
+SunHorizonProfile::open(const uint8_t *buffer, size_t len) {
+  const uint8_t *p = buffer, *end = buffer + len;
+  uint64_t n, sites;
+
+  if (len < 4 || memcmp(p, "SRH1", 4) != 0)
+    return(false);
+  p += 4;
+  if (!getVarint(&p, end, &n) || !getVarint(&p, end, &sites) || n == 0 || n > 0xffff)
+    return(false);
+  if ((size_t)(end - p) / 4 < sites)
+    return(false);
+
+  data = buffer;
+  length = len;
+  directions = (int)n;
+  count = (long)sites;
+  index = p;
+  records = p + sites * 4;
+  return(true);
+}
+
+// Decode the location and profile of a site; altitude must hold azimuths()
+// values.  Any of the results may be NULL.  Returns false if there is no
+// such site.
+bool
+SunHorizonProfile::profile(long site, double *latitude, double *longitude,
+			   float *altitude) const {
+  if (site < 0 || site >= count)
+    return(false);
+
+  const uint8_t *q = index + 4 * site;
+  uint32_t offset = q[0] | q[1] << 8 | (uint32_t)q[2] << 16 | (uint32_t)q[3] << 24;
+  const uint8_t *p = records + offset, *end = data + length;
+  uint64_t lat, lon, delta;
+
+  if (p >= end || !getVarint(&p, end, &lat) || !getVarint(&p, end, &lon))
+    return(false);
+  if (latitude)
+    *latitude = unzigzag(lat) / 1e6;
+  if (longitude)
+    *longitude = unzigzag(lon) / 1e6;
+  if (altitude == NULL)
+    return(true);
+
+  long centi = 0;
+  for (int a = 0; a < directions; a++) {
+    if (!getVarint(&p, end, &delta))
+      return(false);
+    centi += unzigzag(delta);
+    altitude[a] = centi / 100.0f;
+  }
+  return(true);
+}
+
+// The site nearest a location, or -1 if there are none.
+long
+SunHorizonProfile::nearest(double latitude, double longitude) const {
+  double scale = cos(M_PI / 180 * latitude), closest = HUGE_VAL;
+  long found = -1;
+
+  for (long s = 0; s < count; s++) {
+    double lat, lon;
+    if (!profile(s, &lat, &lon, NULL))
+      continue;
+    double dLon = fabs(lon - longitude);
+    dLon = std::min(dLon, 360 - dLon) * scale;
+    double distance = (lat - latitude) * (lat - latitude) + dLon * dLon;
+    if (distance < closest) {
+      closest = distance;
+      found = s;
+    }
+  }
+  return(found);
+}
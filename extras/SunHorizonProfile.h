@@ -0,0 +1,76 @@
+#ifndef SunHorizonProfile_h
+#define SunHorizonProfile_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// The height of a sample with no data.
+#define SR_VOID_HEIGHT	(-32768)
+
+// Horizon profiles of sites, found from a grid of terrain heights, and a
+// compact cache of them for SunRise::calculate() with a SunRiseHorizonMask.
+//
+// A profile is the apparent altitude of the terrain at evenly spaced azimuths
+// from north through east.  Each is found by marching a ray out from the
+// observer over the terrain at each azimuth, allowing for the curvature of
+// the Earth and normal terrestrial refraction, and keeping the highest angle
+// seen.  Steps start at half the grid spacing and lengthen with distance; a
+// ray ends at the edge of the grid, at the given range, or where no terrain
+// in the grid could be higher than the angle already found.  Sites are shared
+// among threads.  A site outside the grid has no profile; compute() leaves it
+// level and counts it.  Voids in the grid, such as SRTM's, must be filled
+// first, e.g. by fillVoids().
+//
+// The cache stores each profile as the zigzag varint differences of its
+// altitudes in hundredths of a degree, usually one byte each, with an index
+// of offsets giving random access to any site.
+//
+// This is host side code; it uses the standard library and is not part of the
+// Arduino library build.
+
+class SunHorizonProfile {
+  public:
+    // Heights in metres, a row at a time from north to south, each row from
+    // west to east.  Samples are at the grid points, so the last row and
+    // column are at north - (rows - 1) * spacing and west + (columns - 1) *
+    // spacing.
+    struct Elevation {
+      const int16_t *height;
+      int columns;
+      int rows;
+      double west;		    // Degrees
+      double north;
+      double spacing;
+    };
+
+    struct Site {
+      double latitude;
+      double longitude;
+      double height;		    // Of the observer above the ground, metres.
+    };
+
+    static long compute(const Elevation &dem, const std::vector<Site> &sites,
+			int azimuths, double range, int threads,
+			std::vector<float> *altitudes);
+    static bool covers(const Elevation &dem, const Site &site);
+    static long fillVoids(int16_t *height, int columns, int rows);
+    static void encode(const std::vector<Site> &sites, int azimuths,
+		       const std::vector<float> &altitudes, std::vector<uint8_t> *out);
+
+    bool open(const uint8_t *data, size_t length);
+    bool profile(long site, double *latitude, double *longitude, float *altitude) const;
+    long nearest(double latitude, double longitude) const;
+
+    long sites() const { return(count); }
+    int azimuths() const { return(directions); }
+
+  private:
+    const uint8_t *data;
+    const uint8_t *index;
+    const uint8_t *records;
+    size_t length;
+    long count;
+    int directions;
+};
+#endif
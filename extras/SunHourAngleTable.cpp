@@ -0,0 +1,260 @@
+// Sun rise and set by interpolation in a table over latitude and the phase of
+// the tropical year.
+//
+// The sun rises when its hour angle reaches -H0 and sets when it reaches H0,
+// where
+//
+//	cos(H0) = (cos(90.833) - sin(latitude) sin(declination))
+//		    / (cos(latitude) cos(declination))
+//
+// cos(H0) is tabulated rather than H0 since it is smooth where the sun stops
+// rising and setting, and the sign of cos(H0) - 1 or cos(H0) + 1 then tells
+// whether the sun stays below or above the horizon.  The hour angle itself is
+// the exact local sidereal time less the right ascension, the latter being
+// the mean sun's longitude plus a tabulated offset.
+//
+// For an observer whose horizon is lowered by height or weather, the sine of
+// the altitude at rise and set changes by a small amount, and cos(H0) by that
+// amount times 1 / (cos(latitude) cos(declination)), which is tabulated too.
+// The azimuths remain those for the standard horizon.
+//
+// Copyright 2020 Cyrus Rahman
+// You may use or modify this source code in any way you find useful, provided
+// that you agree that the author(s) have no warranty, obligations or liability.  You
+// must determine the suitability of this source code for your use.
+//
+// Redistributions of this source code must retain this copyright notice.
+
+#include <math.h>
+#include "SunHourAngleTable.h"
+#include "SunRiseKernel.h"
+#include "SunRiseAnnual.h"		    // SR_TROPICAL_YEAR, SR_MEAN_LONGITUDE
+
+typedef SunRiseKernel<SunRiseLibMath> Kernel;
+
+// Years from 2000 of the year tabulated, and of those compared with it to
+// find the error bounds.
+#define SR_TABLE_EPOCH	    25
+static const int boundEpochs[] = { 0, 25, 50 };
+
+// Stored values of cos(H0) are limited to this magnitude; beyond it the sun
+// is far from rising or setting, and at the poles cos(H0) is infinite.
+#define SR_COS_LIMIT	    2
+#define SR_SECANT_LIMIT	    1000
+
+// Degrees of hour angle to seconds.
+#define SR_SECONDS_PER_DEGREE	(86400.0 / 360)
+
+static double
+wrap180(double degrees) {
+  return(degrees - 360 * floor((degrees + 180) / 360));
+}
+
+static void
+horizonValues(double latitude, double declination, double *cosH0, double *azimuth,
+	      double *secant) {
+  double sl = sin(latitude * M_PI / 180), cl = cos(latitude * M_PI / 180);
+  double sd = sin(declination), cd = cos(declination);
+  double h0 = -0.833 * M_PI / 180;
+  double c = (sin(h0) - sl * sd) / (cl * cd);
+  double a = (sd - sl * sin(h0)) / (cl * cos(h0));
+
+  double r = 1 / (cl * cd);
+
+  *secant = r < SR_SECANT_LIMIT ? r : SR_SECANT_LIMIT;
+  *cosH0 = c > SR_COS_LIMIT ? SR_COS_LIMIT : (c < -SR_COS_LIMIT ? -SR_COS_LIMIT : c);
+  *azimuth = acos(a > 1 ? 1 : (a < -1 ? -1 : a)) * 180 / M_PI;
+}
+
+static double
+clampedHourAngle(double cosH0) {
+  return(acos(cosH0 > 1 ? 1 : (cosH0 < -1 ? -1 : cosH0)) * 180 / M_PI);
+}
+
+// Build the tables: latitudes from -90 to 90 in steps no larger than
+// latitudeStep degrees, and columns evenly spaced through the year.
+SunHourAngleTable::SunHourAngleTable(double latitudeStep, int columns)
+  : rows((int)ceil(180 / latitudeStep) + 1), columns(columns),
+    latitudeStep(180.0 / (rows - 1)), cosHourAngle(rows * columns),
+    riseAzimuth(rows * columns), secant(rows * columns), raOffset(columns), bound((rows - 1) * columns) {
+  for (int col = 0; col < columns; col++) {
+    double d = ((double)col / columns + SR_TABLE_EPOCH) * SR_TROPICAL_YEAR;
+    SunRiseCoordinates sc = Kernel::position(d);
+
+    raOffset[col] = wrap180(sc.RA * 180 / M_PI - SR_MEAN_LONGITUDE(d));
+    for (int row = 0; row < rows; row++) {
+      double c, a, r;
+      horizonValues(-90 + row * this->latitudeStep, sc.declination, &c, &a, &r);
+      cosHourAngle[row * columns + col] = c;
+      riseAzimuth[row * columns + col] = a;
+      secant[row * columns + col] = r;
+    }
+  }
+
+  // Compare the table with the exact hour angle and right ascension at the
+  // corners, edges and middle of each cell, in several years.  Where the
+  // table and the exact values disagree on whether the sun rises and sets
+  // at all, the bound is infinite.
+  int epochs = sizeof(boundEpochs) / sizeof(boundEpochs[0]);
+
+  for (int col = 0; col < columns; col++) {
+    for (int sv = 0; sv <= 2; sv++) {
+      for (int e = 0; e < epochs; e++) {
+	double d = ((col + sv / 2.0) / columns + boundEpochs[e]) * SR_TROPICAL_YEAR;
+	SunRiseCoordinates sc = Kernel::position(d);
+
+	for (int row = 0; row < rows - 1; row++) {
+	  float &b = bound[row * columns + col];
+
+	  for (int su = 0; su <= 2; su++) {
+	    double latitude = -90 + (row + su / 2.0) * this->latitudeStep;
+	    double c, a, r, tc, ta, tra;
+
+	    horizonValues(latitude, sc.declination, &c, &a, &r);
+	    lookup(latitude, d, 0, &tc, &ta, &tra);
+	    double error = fabs(clampedHourAngle(c) - clampedHourAngle(tc))
+	      + fabs(wrap180(sc.RA * 180 / M_PI - tra));
+	    if ((c < 1) != (tc < 1) || (c > -1) != (tc > -1))
+	      b = HUGE_VALF;
+	    else if (error * SR_SECONDS_PER_DEGREE > b)
+	      b = error * SR_SECONDS_PER_DEGREE;
+	  }
+	}
+      }
+    }
+  }
+}
+
+// Find the cell holding a latitude and time, and the position within it.
+void
+SunHourAngleTable::locate(double latitude, double offsetDays, int *row, double *u,
+			  int *column, double *v) const {
+  double y = (latitude + 90) / latitudeStep;
+  int r = (int)floor(y);
+  if (r < 0)
+    r = 0;
+  if (r > rows - 2)
+    r = rows - 2;
+  *row = r;
+  *u = y - r;
+
+  double phase = offsetDays / SR_TROPICAL_YEAR;
+  double x = (phase - floor(phase)) * columns;
+  int c = (int)floor(x);
+  if (c >= columns)
+    c = columns - 1;
+  *column = c;
+  *v = x - c;
+}
+
+// Interpolate cos(H0) for a horizon lifted by lift in the sine of the
+// altitude, the azimuth of sun rise and the right ascension in degrees.
+void
+SunHourAngleTable::lookup(double latitude, double offsetDays, double lift, double *cosH0,
+			  double *azimuth, double *ra) const {
+  int row, col;
+  double u, v;
+
+  locate(latitude, offsetDays, &row, &u, &col, &v);
+  int next = (col + 1) % columns;
+  int i00 = row * columns + col, i01 = row * columns + next;
+  int i10 = i00 + columns, i11 = i01 + columns;
+
+  *cosH0 = (1 - u) * ((1 - v) * cosHourAngle[i00] + v * cosHourAngle[i01])
+    + u * ((1 - v) * cosHourAngle[i10] + v * cosHourAngle[i11])
+    + lift * ((1 - u) * ((1 - v) * secant[i00] + v * secant[i01])
+	      + u * ((1 - v) * secant[i10] + v * secant[i11]));
+  *azimuth = (1 - u) * ((1 - v) * riseAzimuth[i00] + v * riseAzimuth[i01])
+    + u * ((1 - v) * riseAzimuth[i10] + v * riseAzimuth[i11]);
+  *ra = SR_MEAN_LONGITUDE(offsetDays) + (1 - v) * raOffset[col] + v * raOffset[next];
+}
+
+// The sun's hour angle in degrees, from -180 to 180.
+double
+SunHourAngleTable::hourAngle(double longitude, double offsetDays, double ra) const {
+  return(wrap180(Kernel::localSiderealTime(offsetDays, longitude) - ra));
+}
+
+// Refine an estimate of the time of sun rise (direction -1) or set (1),
+// using the declination and right ascension at that time.  Returns false if
+// the sun does not rise or set then.
+bool
+SunHourAngleTable::event(double latitude, double longitude, double offsetDays,
+			 double lift, int direction, double *eventDays,
+			 double *azimuth) const {
+  double c, a, ra;
+
+  lookup(latitude, offsetDays, lift, &c, &a, &ra);
+  if (c >= 1 || c <= -1)
+    return(false);
+  double target = direction * acos(c) * 180 / M_PI;
+  *eventDays = offsetDays + wrap180(target - hourAngle(longitude, offsetDays, ra)) / 360;
+  *azimuth = direction < 0 ? a : 360 - a;
+  return(true);
+}
+
+// Determine the sun rise and set events around a time, as SunRise::calculate()
+// does: the previous rise and next set if the sun is up, otherwise the
+// previous set and next rise.  Returns the error bound in seconds of the
+// table cell used.
+double
+SunHourAngleTable::calculate(SunRise *sr, double latitude, double longitude,
+			     time_t t) const {
+  return(calculate(sr, latitude, longitude, t, Kernel::site(0, 0).horizon));
+}
+
+// Determine the events as above for an observer with a different horizon,
+// given as the horizon constant from SunRiseKernel::horizon() for the
+// observer's conditions, which need only be found once for each observer.
+// The error bound is for the standard horizon.
+double
+SunHourAngleTable::calculate(SunRise *sr, double latitude, double longitude,
+			     time_t t, double horizon) const {
+  double d = Kernel::julianDate(t) - 2451545L;
+  double lift = horizon - Kernel::site(0, 0).horizon;
+  double c, a, ra;
+
+  sr->queryTime = t;
+  sr->riseTime = sr->setTime = 0;
+  sr->riseAz = sr->setAz = 0;
+  sr->hasRise = sr->hasSet = false;
+
+  lookup(latitude, d, lift, &c, &a, &ra);
+  double ha = hourAngle(longitude, d, ra);
+  double h0 = clampedHourAngle(c);
+  sr->isVisible = fabs(ha) < h0;
+
+  // Estimate the events of the solar day holding t, or the neighbouring
+  // event of the previous or next day when the sun is down.
+  double riseDays = (-h0 - ha) / 360, setDays = (h0 - ha) / 360;
+  if (!sr->isVisible) {
+    if (ha > 0)
+      riseDays += 1;
+    else
+      setDays -= 1;
+  }
+
+  double eventDays, azimuth;
+  if (event(latitude, longitude, d + riseDays, lift, -1, &eventDays, &azimuth)) {
+    sr->hasRise = true;
+    sr->riseTime = t + (time_t)floor((eventDays - d) * 86400 + 0.5);
+    sr->riseAz = azimuth;
+  }
+  if (event(latitude, longitude, d + setDays, lift, 1, &eventDays, &azimuth)) {
+    sr->hasSet = true;
+    sr->setTime = t + (time_t)floor((eventDays - d) * 86400 + 0.5);
+    sr->setAz = azimuth;
+  }
+  return(errorBound(latitude, t));
+}
+
+// The largest error, in seconds, found in the table cell for a latitude and
+// time.
+double
+SunHourAngleTable::errorBound(double latitude, time_t t) const {
+  int row, col;
+  double u, v;
+
+  locate(latitude, Kernel::julianDate(t) - 2451545L, &row, &u, &col, &v);
+  return(bound[row * columns + col]);
+}
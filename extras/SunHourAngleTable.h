@@ -0,0 +1,53 @@
+#ifndef SunHourAngleTable_h
+#define SunHourAngleTable_h
+
+#include <time.h>
+#include <vector>
+
+#include "SunRise.h"
+
+// Constant time sun rise and set by table lookup, for clients that make very
+// many queries and can accept errors of a minute or two.
+//
+// The hour angle of sun rise and set, and the azimuth of sun rise, depend only
+// on latitude and the sun's declination, and the declination repeats with the
+// tropical year.  They are tabulated over latitude and the phase of the
+// tropical year, with the sun's right ascension (as its offset from the mean
+// sun) tabulated over phase alone.  A query interpolates bilinearly in these
+// tables and combines the result with the exact local sidereal time, with no
+// evaluation of the sun's position.
+//
+// For each cell of the table the largest error in event time found when the
+// table is built is stored, and returned with each query.
+//
+// This is host side code; it uses the standard library and is not part of the
+// Arduino library build.
+
+class SunHourAngleTable {
+  public:
+    SunHourAngleTable(double latitudeStep = 1, int columns = 366);
+
+    double calculate(SunRise *sr, double latitude, double longitude, time_t t) const;
+    double calculate(SunRise *sr, double latitude, double longitude, time_t t,
+		     double horizon) const;
+    double errorBound(double latitude, time_t t) const;
+
+  private:
+    int rows;
+    int columns;
+    double latitudeStep;
+    std::vector<float> cosHourAngle;	    // rows x columns
+    std::vector<float> riseAzimuth;	    // rows x columns, degrees
+    std::vector<float> secant;		    // rows x columns
+    std::vector<float> raOffset;	    // columns, degrees
+    std::vector<float> bound;		    // (rows - 1) x columns, seconds
+
+    void locate(double latitude, double offsetDays, int *row, double *u,
+		int *column, double *v) const;
+    void lookup(double latitude, double offsetDays, double lift, double *cosH0,
+		double *azimuth, double *ra) const;
+    bool event(double latitude, double longitude, double offsetDays, double lift,
+	       int direction, double *eventDays, double *azimuth) const;
+    double hourAngle(double longitude, double offsetDays, double ra) const;
+};
+#endif
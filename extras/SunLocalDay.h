@@ -0,0 +1,48 @@
+#ifndef SunLocalDay_h
+#define SunLocalDay_h
+
+#include <math.h>
+#include <time.h>
+
+#include "SunRise.h"
+
+// Local mean days at a longitude, for tables of daily events.
+//
+// Days are numbered from the Unix epoch: day d runs from local mean midnight
+// at d * 86400 seconds, less four minutes per degree of east longitude, for
+// 24 hours.  A day's events are the first sun rise and the first sun set
+// within it; either may be missing, or the set may come before the rise.
+//
+// This is host side code and is not part of the Arduino library build.
+
+// The offset of local mean time at a longitude from UTC, in whole seconds.
+static inline long
+sunLocalOffset(double longitude) {
+  return(lround(longitude * 240));
+}
+
+// Local mean midnight and noon of a day, in Unix time.
+static inline time_t
+sunLocalMidnight(long day, double longitude) {
+  return(day * 86400L - sunLocalOffset(longitude));
+}
+
+static inline time_t
+sunLocalNoon(long day, double longitude) {
+  return(sunLocalMidnight(day, longitude) + 43200);
+}
+
+// The number of the local mean day containing t.
+static inline long
+sunLocalDayOf(time_t t, double longitude) {
+  long s = t + sunLocalOffset(longitude);
+  return(s >= 0 ? s / 86400 : -((-s + 86399) / 86400));
+}
+
+// Find the events of a day.  isVisible is left set for its midnight, which
+// with no events tells whether the sun is up all day.
+static inline void
+sunLocalDayEvents(SunRise *sr, double latitude, double longitude, long day) {
+  sr->calculateDay(latitude, longitude, sunLocalMidnight(day, longitude));
+}
+#endif
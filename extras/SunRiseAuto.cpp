@@ -0,0 +1,189 @@
+// Selection of the cheapest sun rise/set engine within a tolerance.
+//
+// Errors are measured against SunRisePrecise, here when other bands are asked
+// for and otherwise by extras/sunriseAutoTable.  When an engine and the
+// reference disagree about whether the sun is up, or whether it rises or sets,
+// the query is close to an event that one of them has placed on the other
+// side of the query time; the error is then taken as the distance from the
+// query time to the nearest reference event.
+//
+// Copyright 2020 Cyrus Rahman
+// You may use or modify this source code in any way you find useful, provided
+// that you agree that the author(s) have no warranty, obligations or liability.  You
+// must determine the suitability of this source code for your use.
+//
+// Redistributions of this source code must retain this copyright notice.
+
+#include <math.h>
+#include <algorithm>
+#include "SunRiseAuto.h"
+#include "SunRiseAnnual.h"
+#include "SunRisePrecise.h"
+#include "SunRiseKernel.h"
+#include "SunRiseAutoTable.h"
+
+// Sample times are drawn from this range of years.
+#define SR_AUTO_FIRST	946684800L		    // 2000
+#define SR_AUTO_SPAN	(50 * 365.2425 * 86400)
+
+// The errors found in a sample understate the largest errors, mostly at high
+// latitudes, so an engine is used only when its measured error times this
+// factor is within the tolerance.
+#define SR_AUTO_MARGIN	2
+
+// A repeatable sequence of numbers in [0, 1), so that the measurements do
+// not depend on, or disturb, the caller's random numbers.
+static double
+sample(unsigned long long *state) {
+  *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return((*state >> 11) * (1.0 / 9007199254740992.0));
+}
+
+static double
+difference(const SunRise &a, const SunRise &b) {
+  double worst = 0;
+
+  if (a.isVisible != b.isVisible || a.hasRise != b.hasRise || a.hasSet != b.hasSet) {
+    worst = HUGE_VAL;
+    if (a.hasRise)
+      worst = fabs((double)(a.riseTime - a.queryTime));
+    if (a.hasSet)
+      worst = std::min(worst, fabs((double)(a.setTime - a.queryTime)));
+    return(worst);
+  }
+  if (a.hasRise)
+    worst = fabs((double)(a.riseTime - b.riseTime));
+  if (a.hasSet)
+    worst = std::max(worst, fabs((double)(a.setTime - b.setTime)));
+  return(worst);
+}
+
+// Take the errors and costs from the shipped table.
+SunRiseAuto::SunRiseAuto()
+  : bandDegrees(SR_AUTO_BAND_DEGREES), bands(SR_AUTO_BANDS),
+    errors(engines * bands, 0) {
+  for (int e = 0; e < precise; e++)
+    for (int b = 0; b < bands; b++)
+      errors[e * bands + b] = sunAutoErrors[e][b];
+  sort();
+}
+
+// Measure the errors in bands of the given width, from the given number of
+// samples in each band.
+SunRiseAuto::SunRiseAuto(double bandDegrees, int samples)
+  : bandDegrees(bandDegrees), bands((int)ceil(180 / bandDegrees)),
+    errors(engines * bands, 0) {
+  struct Sample {
+    double latitude, longitude;
+    time_t t;
+  };
+  std::vector<Sample> points;
+  unsigned long long state = 1;
+
+  for (int b = 0; b < bands; b++) {
+    double south = -90 + b * bandDegrees;
+    double north = std::min(90.0, south + bandDegrees);
+
+    for (int s = 0; s < samples; s++) {
+      Sample p;
+      p.latitude = south + sample(&state) * (north - south);
+      p.longitude = sample(&state) * 360 - 180;
+      p.t = SR_AUTO_FIRST + (time_t)(sample(&state) * SR_AUTO_SPAN);
+      points.push_back(p);
+    }
+  }
+
+  // Run each engine over all of the samples and compare its results with the
+  // reference.
+  std::vector<SunRise> reference(points.size()), results(points.size());
+  for (int e = engines - 1; e >= 0; e--) {
+    std::vector<SunRise> &out = e == precise ? reference : results;
+
+    for (size_t i = 0; i < points.size(); i++)
+      run((Engine)e, &out[i], points[i].latitude, points[i].longitude, points[i].t);
+    if (e == precise)
+      continue;
+    for (size_t i = 0; i < points.size(); i++) {
+      double &worst = errors[e * bands + i / samples];
+      worst = std::max(worst, difference(reference[i], results[i]));
+    }
+  }
+  sort();
+}
+
+// Order the engines by their shipped costs, cheapest first.
+void
+SunRiseAuto::sort() {
+  for (int i = 0; i < engines; i++) {
+    order[i] = (Engine)i;
+    for (int j = i; j > 0 && cost(order[j]) < cost(order[j - 1]); j--)
+      std::swap(order[j], order[j - 1]);
+  }
+}
+
+// Run one engine.  Returns the error bound the engine itself reports, or 0.
+double
+SunRiseAuto::run(Engine engine, SunRise *sr, double latitude, double longitude,
+		 time_t t) const {
+  switch (engine) {
+  case hourAngleTable:
+    return(table.calculate(sr, latitude, longitude, t));
+  case annualTable: {
+    SunRiseAnnual annual;
+    annual.calculate(latitude, longitude, t);
+    *sr = annual;
+    return(0);
+  }
+  case linear:
+    SunRiseKernel<SunRiseLibMath, SunRiseSeries<SunRiseLibMath>,
+		  SunRiseGrid<48, 60, 2> >::calculate(sr, latitude, longitude, t);
+    return(0);
+  case scanning:
+    sr->calculate(latitude, longitude, t);
+    return(0);
+  default: {
+    SunRisePrecise exact;
+    exact.calculate(latitude, longitude, t);
+    *sr = exact;
+    return(0);
+  }
+  }
+}
+
+// Calculate events with the cheapest engine whose measured error at this
+// latitude, with a margin, is no more than tolerance seconds.  Returns the engine used.
+SunRiseAuto::Engine
+SunRiseAuto::calculate(SunRise *sr, double latitude, double longitude, time_t t,
+		       double tolerance) const {
+  for (int i = 0; i < engines; i++) {
+    Engine e = order[i];
+    if (e != precise && error(e, latitude) * SR_AUTO_MARGIN > tolerance)
+      continue;
+    if (run(e, sr, latitude, longitude, t) <= tolerance || e == precise)
+      return(e);
+  }
+  run(precise, sr, latitude, longitude, t);
+  return(precise);
+}
+
+// The cost of a query by an engine, relative to SunRise::calculate().
+double
+SunRiseAuto::cost(Engine engine) const {
+  return(sunAutoCosts[engine]);
+}
+
+// The largest error in seconds measured for an engine at a latitude.
+double
+SunRiseAuto::error(Engine engine, double latitude) const {
+  int b = (int)((latitude + 90) / bandDegrees);
+  return(errors[engine * bands + std::max(0, std::min(b, bands - 1))]);
+}
+
+const char *
+SunRiseAuto::name(Engine engine) {
+  static const char *names[engines] = {
+    "SunHourAngleTable", "SunRiseAnnual", "linear search", "SunRise::calculate",
+    "SunRisePrecise"
+  };
+  return(names[engine]);
+}
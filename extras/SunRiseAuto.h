@@ -0,0 +1,60 @@
+#ifndef SunRiseAuto_h
+#define SunRiseAuto_h
+
+#include <time.h>
+#include <vector>
+
+#include "SunRise.h"
+#include "SunHourAngleTable.h"
+
+// Choose the cheapest engine whose error is within a tolerance.
+//
+// Each engine has been run at a sample of longitudes and times in every band
+// of latitude and compared with SunRisePrecise, and its largest error in each
+// band and its cost per query are shipped in SunRiseAutoTable.h, generated by
+// extras/sunriseAutoTable, so the choice of engine does not depend on the
+// machine or on timings taken at construction.  A selector with other bands
+// measures the errors itself when constructed, which takes a second or two,
+// and still takes the costs from the table.
+//
+// A query gives the largest error it can accept, in seconds, and is answered
+// by the cheapest engine known to be within that error at its latitude,
+// falling back to SunRisePrecise, which is the reference.  The hour angle
+// table also reports the error bound of its cell, which must be within the
+// tolerance too.  Since the errors are measured rather than derived, a
+// tolerance is met by nearly every query rather than guaranteed; and since
+// the reference is itself good only to about a second, tolerances below that
+// are met no better than SunRisePrecise meets them.
+//
+// The linear engine searches calculate()'s window in hourly steps with the
+// sun's position interpolated linearly between two points.
+//
+// This is host side code; it uses the standard library and is not part of the
+// Arduino library build.
+
+class SunRiseAuto {
+  public:
+    enum Engine { hourAngleTable, annualTable, linear, scanning, precise, engines };
+
+    SunRiseAuto();
+    explicit SunRiseAuto(double bandDegrees, int samples = 500);
+
+    Engine calculate(SunRise *sr, double latitude, double longitude, time_t t,
+		     double tolerance) const;
+    double run(Engine engine, SunRise *sr, double latitude, double longitude,
+	       time_t t) const;
+
+    double error(Engine engine, double latitude) const;
+    double cost(Engine engine) const;
+    static const char *name(Engine engine);
+
+  private:
+    double bandDegrees;
+    int bands;
+    SunHourAngleTable table;
+    std::vector<double> errors;		    // engines x bands, seconds
+    Engine order[engines];		    // Cheapest first
+
+    void sort();
+};
+#endif
@@ -0,0 +1,52 @@
+// Errors and costs of the SunRiseAuto engines.
+// Generated by extras/sunriseAutoTable; do not edit.
+//
+// The largest error in seconds found in each 5 degree band of latitude
+// from the south pole, for each engine but SunRisePrecise, and the cost of
+// a query relative to SunRise::calculate().
+
+#define SR_AUTO_BAND_DEGREES	5
+#define SR_AUTO_BANDS		36
+
+static const float sunAutoErrors[4][SR_AUTO_BANDS] = {
+  // SunHourAngleTable
+  {
+    83156, 68810, 85053, 81554, INFINITY, 21, 13, 10,
+    9, 8, 7, 7, 7, 6, 6, 6,
+    6, 6, 6, 6, 6, 5, 7, 7,
+    7, 7, 8, 9, 11, 12, 14, 76415,
+    81922, 78269, 61884, 84141,
+  },
+  // SunRiseAnnual
+  {
+    157, 95, 50529, 104, INFINITY, 27, 12, 12,
+    10, 9, 9, 8, 8, 8, 8, 7,
+    7, 7, 7, 7, 7, 7, 7, 7,
+    8, 8, 10, 11, 13, 13, 23, 86924,
+    59, INFINITY, 25251, 73,
+  },
+  // linear search
+  {
+    211, 81, 50529, 88300, INFINITY, 30, 11, 10,
+    7, 7, 6, 6, 6, 5, 5, 5,
+    4, 4, 4, 5, 5, 5, 5, 5,
+    6, 6, 7, 8, 10, 10, 19, 86936,
+    57, INFINITY, 25251, 70,
+  },
+  // SunRise::calculate
+  {
+    180, 92, 50529, 88368, INFINITY, 21, 9, 8,
+    7, 6, 5, 5, 6, 5, 5, 5,
+    4, 4, 4, 5, 4, 4, 5, 5,
+    5, 5, 6, 7, 9, 9, 15, 86921,
+    62, INFINITY, 25251, 69,
+  },
+};
+
+static const float sunAutoCosts[5] = {
+  0.089,		// SunHourAngleTable
+  0.873,		// SunRiseAnnual
+  0.940,		// linear search
+  1.000,		// SunRise::calculate
+  4.694,		// SunRisePrecise
+};
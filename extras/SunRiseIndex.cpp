@@ -0,0 +1,186 @@
+// Latitude band and longitude index of sites for sun rise queries.
+//
+// The sun rises at a site when its hour angle reaches -H0, where
+//
+//	cos(H0) = (sin(h0) - sin(latitude) sin(declination))
+//		    / (cos(latitude) cos(declination))
+//
+// and h0 is the altitude of sun rise.  The hour angle at a site is its
+// longitude less that of the subsolar point, so at any moment the sun is
+// rising at longitude subsolarLongitude - H0.  Between two times the subsolar
+// point moves west, and the sites seeing the sun rise in a band lie between
+// the rising longitude at the end of the period, for the largest H0 in the
+// band, and that at its start, for the smallest.  Sites with a lowered
+// horizon have a lower h0, and so a larger H0; each band keeps the range of
+// sin(h0), the horizon constant, of its sites.
+//
+// Copyright 2020 Cyrus Rahman
+// You may use or modify this source code in any way you find useful, provided
+// that you agree that the author(s) have no warranty, obligations or liability.  You
+// must determine the suitability of this source code for your use.
+//
+// Redistributions of this source code must retain this copyright notice.
+
+#include <math.h>
+#include <algorithm>
+#include "SunRiseIndex.h"
+#include "SunRise.h"
+#include "SunTerminator.h"
+
+typedef SunRiseKernel<SunRiseLibMath> Kernel;
+
+// Widening of each longitude range, covering the difference between the
+// closed form hour angle and the interpolated events of the SunRise engine.
+#define SR_INDEX_MARGIN	0.5	    // Degrees of longitude, two minutes
+
+SunRiseIndex::SunRiseIndex(double bandDegrees)
+  : bandDegrees(bandDegrees), bands((int)ceil(180 / bandDegrees)),
+    lowest(bands.size(), Kernel::site(0, 0).horizon),
+    highest(bands.size(), Kernel::site(0, 0).horizon), sorted(true) {
+}
+
+// Add a site.  Returns the site number reported by rising().
+size_t
+SunRiseIndex::addSite(double latitude, double longitude) {
+  Entry e;
+  size_t band = std::min((size_t)((latitude + 90) / bandDegrees), bands.size() - 1);
+
+  longitude -= 360 * floor((longitude + 180) / 360);
+  e.longitude = longitude;
+  e.site = constants.size();
+  bands[band].push_back(e);
+  constants.push_back(Kernel::site(latitude, longitude));
+  sorted = false;
+  return(e.site);
+}
+
+// Add a site as above, for an observer in the given conditions, as for
+// SunRise::calculate() with them.
+size_t
+SunRiseIndex::addSite(double latitude, double longitude, const SunRiseConditions &conditions) {
+  size_t site = addSite(latitude, longitude);
+  size_t band = std::min((size_t)((latitude + 90) / bandDegrees), bands.size() - 1);
+  double horizon = Kernel::horizon(conditions);
+
+  constants[site].horizon = horizon;
+  lowest[band] = std::min(lowest[band], horizon);
+  highest[band] = std::max(highest[band], horizon);
+  return(site);
+}
+
+// The rising hour angle, in degrees, for a horizon constant sin(h0), clamped
+// to 0 when the sun stays below the horizon and to 180 when it stays above.
+static double
+risingHourAngle(double latitude, double declination, double sinH0) {
+  double lat = latitude * M_PI / 180, dec = declination * M_PI / 180;
+  double c = (sinH0 - sin(lat) * sin(dec)) / (cos(lat) * cos(dec));
+  return(acos(c > 1 ? 1 : (c < -1 ? -1 : c)) * 180 / M_PI);
+}
+
+// Find the sites at which the sun rises after from and no later than to,
+// with the time and azimuth of the first such sun rise at each.
+void
+SunRiseIndex::rising(time_t from, time_t to, std::vector<Rise> *rises) {
+  SunTerminator start, end;
+
+  rises->clear();
+  if (to <= from)
+    return;
+  if (!sorted) {
+    for (size_t b = 0; b < bands.size(); b++)
+      std::sort(bands[b].begin(), bands[b].end());
+    sorted = true;
+  }
+
+  start.calculate(from);
+  end.calculate(to);
+  double startLongitude = start.subsolarLongitude;
+  double endLongitude = end.subsolarLongitude;
+  while (endLongitude > startLongitude)
+    endLongitude -= 360;
+  endLongitude -= 360 * floor((double)(to - from) / 86400);
+
+  double declinations[2] = { start.subsolarLatitude, end.subsolarLatitude };
+
+  for (size_t b = 0; b < bands.size(); b++) {
+    if (bands[b].empty())
+      continue;
+    double south = -90 + b * bandDegrees;
+    double north = std::min(90.0, south + bandDegrees);
+    double least = 180, most = 0;
+
+    // The rising hour angle is monotonic in latitude except where
+    // sin(latitude) = sin(declination) / sin(h0), which is only within the
+    // range of latitude when the declination is near zero.  It is monotonic
+    // in sin(h0), so the band's highest horizon gives the least and its
+    // lowest the most.
+    double sinH0s[2] = { highest[b], lowest[b] };
+    for (int d = 0; d < 2; d++) {
+      for (int k = 0; k < 2; k++) {
+	double lats[3] = { south, north, south };
+	double s = sin(declinations[d] * M_PI / 180) / sinH0s[k];
+	if (s >= -1 && s <= 1) {
+	  double turn = asin(s) * 180 / M_PI;
+	  if (turn > south && turn < north)
+	    lats[2] = turn;
+	}
+	for (int l = 0; l < 3; l++) {
+	  double h = risingHourAngle(lats[l], declinations[d], sinH0s[k]);
+	  least = std::min(least, h);
+	  most = std::max(most, h);
+	}
+      }
+    }
+
+    scan(bands[b], endLongitude - most - SR_INDEX_MARGIN,
+	 startLongitude - least + SR_INDEX_MARGIN, from, to, rises);
+  }
+}
+
+// Confirm each site in a band between the west and east longitudes.
+void
+SunRiseIndex::scan(const std::vector<Entry> &band, double west, double east,
+		   time_t from, time_t to, std::vector<Rise> *rises) const {
+  std::vector<Entry>::const_iterator i, first;
+
+  if (east - west >= 360) {
+    west = -180;
+    east = 180;
+  }
+  double shift = 360 * floor((west + 180) / 360);
+  west -= shift;
+  east -= shift;
+
+  Entry key;
+  key.longitude = west;
+  first = std::lower_bound(band.begin(), band.end(), key);
+
+  // The range may continue past 180 degrees onto the start of the band.
+  for (int pass = 0; pass < 2; pass++) {
+    for (i = first; i != band.end() && i->longitude <= east; ++i) {
+      SunRise sr;
+      time_t t = from;
+
+      // When the sun is up at the start of the period, look for a rise after
+      // the next set.
+      for (;;) {
+	Kernel::search(&sr, constants[i->site], t);
+	if (sr.hasRise && sr.riseTime > t && sr.riseTime <= to) {
+	  Rise r;
+	  r.site = i->site;
+	  r.riseTime = sr.riseTime;
+	  r.riseAz = sr.riseAz;
+	  rises->push_back(r);
+	  break;
+	}
+	if (!sr.isVisible || !sr.hasSet || sr.setTime <= t || sr.setTime >= to)
+	  break;
+	t = sr.setTime + 60;	    // Past the set just found.
+      }
+    }
+    if (east <= 180)
+      break;
+    first = band.begin();
+    east -= 360;
+  }
+}
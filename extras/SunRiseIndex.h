@@ -0,0 +1,56 @@
+#ifndef SunRiseIndex_h
+#define SunRiseIndex_h
+
+#include <stddef.h>
+#include <time.h>
+#include <vector>
+
+#include "SunRiseKernel.h"
+
+// Find the sites that will see the sun rise within a period of time.
+//
+// Sites are divided into bands of latitude, and each band is kept sorted by
+// longitude.  The sun rises along the morning half of the terminator, which
+// moves west at about 15 degrees an hour; within a band of latitude it lies
+// within a narrow range of longitude that is found from the subsolar point
+// and the rising hour angles at the edges of the band.  A query is then a
+// range scan of each band, and only the sites found are confirmed with the
+// SunRise engine.  Sites may be given the observer's height and weather;
+// the range of horizons in each band widens its range of longitude.
+//
+// This is host side code; it uses the standard library and is not part of the
+// Arduino library build.
+
+class SunRiseIndex {
+  public:
+    struct Rise {
+      size_t site;
+      time_t riseTime;
+      float riseAz;
+    };
+
+    SunRiseIndex(double bandDegrees = 1);
+
+    size_t addSite(double latitude, double longitude);
+    size_t addSite(double latitude, double longitude, const SunRiseConditions &conditions);
+    size_t sites() const { return(constants.size()); }
+
+    void rising(time_t from, time_t to, std::vector<Rise> *rises);
+
+  private:
+    struct Entry {
+      double longitude;
+      size_t site;
+      bool operator<(const Entry &e) const { return(longitude < e.longitude); }
+    };
+
+    double bandDegrees;
+    std::vector<std::vector<Entry> > bands;
+    std::vector<double> lowest, highest;	    // Horizon constants in each band
+    std::vector<SunRiseSite> constants;
+    bool sorted;
+
+    void scan(const std::vector<Entry> &band, double west, double east,
+	      time_t from, time_t to, std::vector<Rise> *rises) const;
+};
+#endif
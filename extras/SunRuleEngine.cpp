@@ -0,0 +1,236 @@
+// Bulk evaluation of rules expressed relative to sun rise and set.
+//
+// Copyright 2020 Cyrus Rahman
+// You may use or modify this source code in any way you find useful, provided
+// that you agree that the author(s) have no warranty, obligations or liability.  You
+// must determine the suitability of this source code for your use.
+//
+// Redistributions of this source code must retain this copyright notice.
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "SunRuleEngine.h"
+#include "SunRiseKernel.h"
+
+// Room for the events of one search window; the sun rises and sets at most a
+// few times in two days even near the poles.
+#define SR_RULE_WINDOW_EVENTS	16
+
+typedef SunRiseKernel<SunRiseLibMath> Kernel;
+
+size_t
+SunRuleEngine::addSite(double latitude, double longitude, long utcOffset) {
+  Site s;
+  s.latitude = latitude;
+  s.longitude = longitude;
+  s.utcOffset = utcOffset;
+  sites.push_back(s);
+  return(sites.size() - 1);
+}
+
+// Parse "HH:MM" into seconds after midnight.  Returns NULL on error.
+static const char *
+parseClock(const char *p, long *seconds) {
+  char *end;
+  long h = strtol(p, &end, 10);
+
+  if (end == p || *end != ':' || h < 0 || h > 23)
+    return(NULL);
+  p = end + 1;
+  long m = strtol(p, &end, 10);
+  if (end == p || m < 0 || m > 59)
+    return(NULL);
+  *seconds = h * 3600 + m * 60;
+  return(end);
+}
+
+// Parse one time specification.  Returns a pointer past it, or NULL on error.
+const char *
+SunRuleEngine::parseTime(const char *p, TimeSpec *spec) {
+  spec->clock = 0;
+  spec->offset = 0;
+  spec->notBefore = -1;
+  spec->notAfter = -1;
+
+  while (isspace(*p))
+    p++;
+  if (strncmp(p, "sunrise", 7) == 0) {
+    spec->anchor = anchorRise;
+    p += 7;
+  } else if (strncmp(p, "sunset", 6) == 0) {
+    spec->anchor = anchorSet;
+    p += 6;
+  } else {
+    spec->anchor = anchorClock;
+    if ((p = parseClock(p, &spec->clock)) == NULL)
+      return(NULL);
+  }
+
+  if (*p == '+' || *p == '-') {
+    char *end;
+    long n = strtol(p + 1, &end, 10);
+    if (end == p + 1 || (*end != 'm' && *end != 'h'))
+      return(NULL);
+    n *= (*end == 'h') ? 3600 : 60;
+    if (n >= SR_WINDOW / 2 * 3600)
+      return(NULL);
+    spec->offset = (*p == '-') ? -n : n;
+    p = end + 1;
+  }
+
+  for (;;) {
+    while (isspace(*p))
+      p++;
+    if (*p == '>') {
+      if ((p = parseClock(p + 1, &spec->notBefore)) == NULL)
+	return(NULL);
+    } else if (*p == '<') {
+      if ((p = parseClock(p + 1, &spec->notAfter)) == NULL)
+	return(NULL);
+    } else
+      break;
+  }
+  return(p);
+}
+
+// Compile a rule for a site.  Returns the rule number, which indexes the
+// results of evaluate(), or -1 if the rule cannot be parsed.
+long
+SunRuleEngine::addRule(size_t site, const char *text) {
+  Rule r;
+
+  if (site >= sites.size() || (text = parseTime(text, &r.start)) == NULL)
+    return(-1);
+  r.site = site;
+  r.hasEnd = false;
+  if (strncmp(text, "until", 5) == 0) {
+    if ((text = parseTime(text + 5, &r.end)) == NULL)
+      return(-1);
+    r.hasEnd = true;
+  }
+  while (isspace(*text))
+    text++;
+  if (*text != '\0')
+    return(-1);
+
+  rules.push_back(r);
+  sites[site].rules.push_back(rules.size() - 1);
+  return(rules.size() - 1);
+}
+
+// Collect every rise and set event of a site from the specified time to
+// until, in time order, listing a window at a time.  An event on the boundary
+// of two windows may be found by both, and is kept once.
+void
+SunRuleEngine::siteEvents(const Site &site, time_t from, time_t until,
+			  std::vector<Event> *events) {
+  SunRiseEvent list[SR_RULE_WINDOW_EVENTS];
+
+  events->clear();
+  for (time_t t = from; t < until; t += SR_WINDOW * 3600L) {
+    int n = std::min(Kernel::events(site.latitude, site.longitude, t, list,
+				    SR_RULE_WINDOW_EVENTS), SR_RULE_WINDOW_EVENTS);
+    for (int i = 0; i < n; i++) {
+      Event e = { list[i].time, list[i].rise ? anchorRise : anchorSet };
+      bool seen = false;
+      for (size_t k = events->size(); k > 0 && !seen; k--)
+	seen = (*events)[k - 1].type == e.type &&
+	       labs((long)((*events)[k - 1].time - e.time)) < SR_EVENT_GUARD;
+      if (!seen)
+	events->push_back(e);
+    }
+  }
+}
+
+// How long after its anchor event a time specification can fall.
+long
+SunRuleEngine::reach(const TimeSpec &spec) {
+  return(labs(spec.offset) + (spec.notBefore >= 0 ? 86400 : 0));
+}
+
+// Apply the local clock limits of a time specification.
+static time_t
+clamp(time_t t, long utcOffset, long notBefore, long notAfter) {
+  time_t local = t + utcOffset;
+  time_t dayStart = local - ((local % 86400) + 86400) % 86400 - utcOffset;
+
+  if (notBefore >= 0 && t < dayStart + notBefore)
+    t = dayStart + notBefore;
+  if (notAfter >= 0 && t > dayStart + notAfter)
+    t = dayStart + notAfter;
+  return(t);
+}
+
+// Find the first occurrence of a time specification after a given time.
+bool
+SunRuleEngine::occurrence(const Site &site, const std::vector<Event> &events,
+			  const TimeSpec &spec, time_t after, time_t *t) {
+  if (spec.anchor == anchorClock) {
+    time_t local = after + site.utcOffset;
+    time_t c = local - ((local % 86400) + 86400) % 86400 - site.utcOffset +
+	       spec.clock + spec.offset;
+    for (int i = 0; i < 3; i++, c += 86400) {
+      time_t limited = clamp(c, site.utcOffset, spec.notBefore, spec.notAfter);
+      if (limited > after) {
+	*t = limited;
+	return(true);
+      }
+    }
+    return(false);
+  }
+
+  for (size_t i = 0; i < events.size(); i++) {
+    if (events[i].type != spec.anchor)
+      continue;
+    time_t limited = clamp(events[i].time + spec.offset, site.utcOffset,
+			   spec.notBefore, spec.notAfter);
+    if (limited > after) {
+      *t = limited;
+      return(true);
+    }
+  }
+  return(false);
+}
+
+// Determine the next activation of every rule after the specified time.  The
+// result for rule n is stored at (*activations)[n].
+void
+SunRuleEngine::evaluate(time_t now, std::vector<Activation> *activations) const {
+  std::vector<Event> events;
+
+  activations->resize(rules.size());
+  for (size_t s = 0; s < sites.size(); s++) {
+    const Site &site = sites[s];
+    if (site.rules.empty())
+      continue;
+
+    // An anchor before now may still give an activation after it, by up to
+    // its offset and a day more when a "not before" limit moves it on, and
+    // an end may follow a start that is itself nearly a day away, so events
+    // are listed from that far back to two windows after now.
+    long lead = 0;
+    for (size_t i = 0; i < site.rules.size(); i++) {
+      const Rule &r = rules[site.rules[i]];
+      lead = std::max(lead, reach(r.start));
+      if (r.hasEnd)
+	lead = std::max(lead, reach(r.end));
+    }
+    siteEvents(site, now - lead, now + 2 * SR_WINDOW * 3600L, &events);
+
+    for (size_t i = 0; i < site.rules.size(); i++) {
+      const Rule &r = rules[site.rules[i]];
+      Activation *a = &(*activations)[site.rules[i]];
+
+      a->hasStart = occurrence(site, events, r.start, now, &a->start);
+      a->hasEnd = a->hasStart && r.hasEnd &&
+		  occurrence(site, events, r.end, a->start, &a->end);
+      if (!a->hasStart)
+	a->start = 0;
+      if (!a->hasEnd)
+	a->end = 0;
+    }
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef SunRuleEngine_h
+#define SunRuleEngine_h
+
+#include <stddef.h>
+#include <time.h>
+#include <vector>
+
+// Evaluate automation rules expressed relative to sun rise and set.
+//
+// Rules are compiled once from text of the form
+//
+//	sunset+30m >18:00 until sunrise-45m
+//
+// and evaluated in bulk.  The sun rise and set events of each site are
+// computed once per evaluation and shared by all of that site's rules.
+//
+// Grammar:
+//	rule   := time ["until" time]
+//	time   := anchor [offset] [">" HH:MM] ["<" HH:MM]
+//	anchor := "sunrise" | "sunset" | HH:MM
+//	offset := ("+" | "-") number ("m" | "h")
+//
+// ">HH:MM" means not before, and "<HH:MM" not after, that local clock time on
+// the day of the event.  Offsets must be less than SR_WINDOW/2 hours.
+
+class SunRuleEngine {
+  public:
+    struct Activation {
+      time_t start;		    // Next activation after the evaluation time.
+      time_t end;		    // First end time after start.
+      bool hasStart;
+      bool hasEnd;
+    };
+
+    size_t addSite(double latitude, double longitude, long utcOffset);
+    long addRule(size_t site, const char *rule);
+    void evaluate(time_t now, std::vector<Activation> *activations) const;
+
+  private:
+    enum Anchor { anchorRise, anchorSet, anchorClock };
+
+    struct TimeSpec {
+      Anchor anchor;
+      long clock;		    // Local seconds after midnight for anchorClock.
+      long offset;		    // Seconds.
+      long notBefore;		    // Local seconds after midnight, or -1.
+      long notAfter;		    // Local seconds after midnight, or -1.
+    };
+
+    struct Rule {
+      size_t site;
+      TimeSpec start;
+      TimeSpec end;
+      bool hasEnd;
+    };
+
+    struct Site {
+      double latitude;
+      double longitude;
+      long utcOffset;		    // Seconds east of UTC.
+      std::vector<size_t> rules;
+    };
+
+    struct Event {
+      time_t time;
+      Anchor type;
+    };
+
+    std::vector<Site> sites;
+    std::vector<Rule> rules;
+
+    static const char *parseTime(const char *p, TimeSpec *spec);
+    static long reach(const TimeSpec &spec);
+    static void siteEvents(const Site &site, time_t from, time_t until,
+			   std::vector<Event> *events);
+    static bool occurrence(const Site &site, const std::vector<Event> &events,
+			   const TimeSpec &spec, time_t after, time_t *t);
+};
+#endif
@@ -0,0 +1,16 @@
+// Size profile: SunRiseAnnual::calculate(), with the sun's position from a
+// table of one year.
+
+#include "SunRiseAnnual.h"
+
+volatile double latitude = 42, longitude = -90;
+volatile time_t when = 1700000000;
+volatile bool result;
+
+int
+main() {
+  SunRiseAnnual sr;
+  sr.calculate(latitude, longitude, when);
+  result = sr.isVisible;
+  return(0);
+}
@@ -0,0 +1,15 @@
+// Size profile: SunRise::calculate() at a location given at run time.
+
+#include "SunRise.h"
+
+volatile double latitude = 42, longitude = -90;
+volatile time_t when = 1700000000;
+volatile bool result;
+
+int
+main() {
+  SunRise sr;
+  sr.calculate(latitude, longitude, when);
+  result = sr.isVisible;
+  return(0);
+}
@@ -0,0 +1,15 @@
+// Size profile: SunRise::calculateDay(), the events of one local day.
+
+#include "SunRise.h"
+
+volatile double latitude = 42, longitude = -90;
+volatile time_t when = 1699941600;
+volatile bool result;
+
+int
+main() {
+  SunRise sr;
+  sr.calculateDay(latitude, longitude, when);
+  result = sr.isVisible;
+  return(0);
+}
@@ -0,0 +1,7 @@
+// Size profile baseline: the cost of the runtime alone, subtracted from the
+// other profiles.
+
+int
+main() {
+  return(0);
+}
@@ -0,0 +1,20 @@
+// Size profile: SunRiseFixed<Location>::calculate() at a site fixed at
+// compile time.
+
+#include "SunRiseFixed.h"
+
+struct Site {
+  static constexpr double latitude = 42;
+  static constexpr double longitude = -90;
+};
+
+volatile time_t when = 1700000000;
+volatile bool result;
+
+int
+main() {
+  SunRiseFixed<Site> sr;
+  sr.calculate(when);
+  result = sr.isVisible;
+  return(0);
+}
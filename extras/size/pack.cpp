@@ -0,0 +1,13 @@
+// Size profile: SunRise::pack() and SunRise::unpack().
+
+#include "SunRise.h"
+
+SunRise sr;
+SunRisePacked packed;
+
+int
+main() {
+  sr.pack(&packed);
+  sr.unpack(&packed);
+  return(0);
+}
@@ -0,0 +1,16 @@
+// Size profile: SunRisePrecise::calculate(), with the sun's position from
+// VSOP87.
+
+#include "SunRisePrecise.h"
+
+volatile double latitude = 42, longitude = -90;
+volatile time_t when = 1700000000;
+volatile bool result;
+
+int
+main() {
+  SunRisePrecise sr;
+  sr.calculate(latitude, longitude, when);
+  result = sr.isVisible;
+  return(0);
+}
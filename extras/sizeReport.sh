@@ -0,0 +1,77 @@
+#!/bin/sh
+#
+# Report the flash and RAM used by each feature of the engine when built for
+# the size-optimized profile, and check them against budgets.  Run from the
+# Makefile ("make size"), which supplies the environment:
+#
+#	CXX, SIZE, NM	    compiler, size(1) and nm(1), with any cross prefix
+#	PROFILE_FLAGS	    compiler flags of the size profile
+#	PROFILE_LDFLAGS	    linker flags of the size profile
+#	BUILD		    directory for objects
+#	FLASH_BUDGET	    largest flash (text + data) allowed per feature, or 0
+#	RAM_BUDGET	    largest RAM (data + bss + stack) allowed per feature, or 0
+#
+# Each feature is a small program in size/.  Its cost is measured against
+# size/empty.cpp, so it includes the library and math routines it pulls in.
+# Stack is the sum of the frames of every function linked into the feature,
+# an upper bound on its depth.
+
+set -e
+cd "$(dirname "$0")"
+mkdir -p "$BUILD"
+
+# Build a feature program from its sources and measure it.
+measure() {
+  name=$1
+  shift
+  objects=
+  rm -f "$BUILD"/*.o "$BUILD"/*.su
+  for source in "$@"; do
+    object="$BUILD/$(basename "$source" .cpp).o"
+    $CXX $PROFILE_FLAGS -fstack-usage -I.. -c "$source" -o "$object"
+    objects="$objects $object"
+  done
+  $CXX $PROFILE_FLAGS $objects -o "$BUILD/$name" $PROFILE_LDFLAGS
+  set -- $($SIZE -B "$BUILD/$name" | awk 'NR == 2 { print $1, $2, $3 }')
+  text=$1 data=$2 bss=$3
+  # Function names, without template arguments or parameters, of the
+  # functions remaining after unused sections are discarded.
+  $NM -C "$BUILD/$name" | awk '$2 ~ /^[tTwW]$/ { $1 = $2 = ""; print }' |
+    sed 's/<[^>]*>//g; s/(.*//; s/^ *//' | sort -u > "$BUILD/live"
+  stack=$(cat "$BUILD"/*.su | awk -F '\t' '
+    FILENAME == "-" {
+      n = $1
+      sub(/^[^:]*:[^:]*:[^:]*:/, "", n)
+      sub(/\(.*/, "", n)
+      gsub(/<[^>]*>/, "", n)
+      k = split(n, w, " ")
+      if ($2 > frame[w[k]])
+	frame[w[k]] = $2
+      next
+    }
+    { live[$0] = 1 }
+    END { for (f in frame) if (f in live) s += frame[f]; print s + 0 }
+  ' - "$BUILD/live")
+}
+
+measure empty size/empty.cpp
+baseText=$text baseData=$data baseBss=$bss
+
+failed=0
+printf "%-12s %8s %8s %8s %8s %8s\n" feature flash text data bss stack
+for feature in calculate fixed annual precise day pack; do
+  measure $feature size/$feature.cpp ../SunRise.cpp ../SunRiseAnnual.cpp \
+    ../SunRisePrecise.cpp
+  t=$((text - baseText)) d=$((data - baseData)) b=$((bss - baseBss))
+  flash=$((t + d)) ram=$((d + b + stack))
+  printf "%-12s %8d %8d %8d %8d %8d\n" $feature $flash $t $d $b $stack
+  if [ "${FLASH_BUDGET:-0}" -gt 0 ] && [ $flash -gt "$FLASH_BUDGET" ]; then
+    echo "$feature: flash $flash exceeds budget $FLASH_BUDGET"
+    failed=1
+  fi
+  if [ "${RAM_BUDGET:-0}" -gt 0 ] && [ $ram -gt "$RAM_BUDGET" ]; then
+    echo "$feature: RAM $ram exceeds budget $RAM_BUDGET"
+    failed=1
+  fi
+done
+exit $failed
@@ -0,0 +1,183 @@
+/*
+ * Generate a C++ header holding a compressed almanac of daily sun rise and set
+ * times for one location, for devices that never move.
+ *
+ * Usage: sunriseAlmanac name latitude longitude first-year years > name.h
+ *
+ * The header defines, with the prefix "name":
+ *
+ *	bool name_day(long day, bool *hasRise, time_t *riseTime,
+ *		      bool *hasSet, time_t *setTime, bool *upAllDay);
+ *	long name_dayOf(time_t t);
+ *
+ * name_day() gives the first sun rise and set of a local mean day numbered from
+ * the Unix epoch as by SunLocalDay.h, to the minute, and returns false outside
+ * the table.  name_dayOf() gives the number of the local day containing t.
+ *
+ * Each day takes one byte: two four bit fields hold the day-to-day change in
+ * the rise and set times in minutes.  Larger changes, and missing events, are
+ * escaped with a full twelve bit value.  An index of 32 day blocks limits a
+ * lookup to decoding at most one block.  The tables are placed in PROGMEM.
+ *
+ * Build:  g++ -O2 -I.. sunriseAlmanac.cpp ../SunRise.cpp
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+#include "SunLocalDay.h"
+
+#define BLOCK_DAYS	32
+#define ESCAPE		15	    // Nibble introducing a twelve bit value.
+#define ABSOLUTE_BIAS	2048	    // Added to twelve bit minutes from noon.
+#define NO_EVENT_DOWN	0xffe	    // Twelve bit values for missing events.
+#define NO_EVENT_UP	0xfff
+
+static std::vector<uint8_t> nibbles;
+
+// Days from the Unix epoch to January 1 of a year.
+static long
+daysFromYear(long y) {
+  y -= 1;
+  return(365 * (y - 1969) + (y / 4 - 492) - (y / 100 - 19) + (y / 400 - 4));
+}
+
+static void
+putAbsolute(int v) {
+  nibbles.push_back(ESCAPE);
+  nibbles.push_back(v >> 8 & 0xf);
+  nibbles.push_back(v >> 4 & 0xf);
+  nibbles.push_back(v & 0xf);
+}
+
+// Append one event, as a change from the previous event of its type if small.
+static void
+putEvent(bool has, bool up, long minutes, long *prev, bool *prevValid) {
+  if (!has) {
+    putAbsolute(up ? NO_EVENT_UP : NO_EVENT_DOWN);
+    *prevValid = false;
+    return;
+  }
+  long delta = minutes - *prev;
+  if (*prevValid && delta >= -7 && delta <= 7)
+    nibbles.push_back(delta < 0 ? -2 * delta - 1 : 2 * delta);
+  else
+    putAbsolute(minutes + ABSOLUTE_BIAS);
+  *prev = minutes;
+  *prevValid = true;
+}
+
+int
+main(int argc, char *argv[]) {
+  if (argc != 6) {
+    fprintf(stderr, "usage: %s name latitude longitude first-year years\n", argv[0]);
+    return(1);
+  }
+  const char *name = argv[1];
+  double latitude = atof(argv[2]);
+  double longitude = atof(argv[3]);
+  long firstDay = daysFromYear(atol(argv[4]));
+  long days = daysFromYear(atol(argv[4]) + atol(argv[5])) - firstDay;
+  long noonOffset = sunLocalNoon(0, longitude);
+  std::vector<unsigned long> index;
+  long prevRise = 0, prevSet = 0;
+  bool riseValid = false, setValid = false;
+  SunRise sr;
+
+  for (long i = 0; i < days; i++) {
+    if (i % BLOCK_DAYS == 0) {
+      index.push_back(nibbles.size());
+      riseValid = setValid = false;
+    }
+    time_t noon = sunLocalNoon(firstDay + i, longitude);
+    sunLocalDayEvents(&sr, latitude, longitude, firstDay + i);
+
+    putEvent(sr.hasRise, sr.isVisible, lround((sr.riseTime - noon) / 60.0),
+	     &prevRise, &riseValid);
+    putEvent(sr.hasSet, sr.isVisible, lround((sr.setTime - noon) / 60.0),
+	     &prevSet, &setValid);
+  }
+  if (nibbles.size() % 2)
+    nibbles.push_back(0);
+
+  const char *indexType = nibbles.size() < 65536 ? "uint16_t" : "uint32_t";
+
+  printf("// Generated by sunriseAlmanac for latitude %.6f longitude %.6f,\n"
+	 "// %ld days from day %ld (%s years from %s).  Do not edit.\n\n",
+	 latitude, longitude, days, firstDay, argv[5], argv[4]);
+  printf("#ifndef %s_h\n#define %s_h\n\n", name, name);
+  printf("#include <stdint.h>\n#include <time.h>\n\n"
+	 "#ifdef ARDUINO\n#include <Arduino.h>\n#else\n"
+	 "#ifndef PROGMEM\n#define PROGMEM\n#endif\n"
+	 "#ifndef pgm_read_byte\n#define pgm_read_byte(p) (*(const uint8_t *)(p))\n#endif\n"
+	 "#ifndef pgm_read_word\n#define pgm_read_word(p) (*(const uint16_t *)(p))\n#endif\n"
+	 "#ifndef pgm_read_dword\n#define pgm_read_dword(p) (*(const uint32_t *)(p))\n#endif\n"
+	 "#endif\n\n");
+
+  printf("static constexpr long %s_firstDay = %ld;\n", name, firstDay);
+  printf("static constexpr long %s_days = %ld;\n", name, days);
+  printf("static constexpr long %s_noonOffset = %ld;\n\n", name, noonOffset);
+
+  printf("static constexpr %s %s_index[] PROGMEM = {", indexType, name);
+  for (size_t i = 0; i < index.size(); i++)
+    printf("%s%lu,", i % 12 ? " " : "\n  ", index[i]);
+  printf("\n};\n\n");
+
+  printf("static constexpr uint8_t %s_data[] PROGMEM = {", name);
+  for (size_t i = 0; i < nibbles.size(); i += 2)
+    printf("%s0x%02x,", (i / 2) % 12 ? " " : "\n  ", nibbles[i] << 4 | nibbles[i + 1]);
+  printf("\n};\n\n");
+
+  printf("static inline long\n%s_dayOf(time_t t) {\n"
+	 "  long s = t - %s_noonOffset + 43200;\n"
+	 "  return(s >= 0 ? s / 86400 : -((-s + 86399) / 86400));\n}\n\n", name, name);
+
+  printf("static inline int\n%s_nibble(unsigned long n) {\n"
+	 "  uint8_t b = pgm_read_byte(&%s_data[n / 2]);\n"
+	 "  return(n %% 2 ? b & 0xf : b >> 4);\n}\n\n", name, name);
+
+  printf("// Decode one event, updating its running value in minutes from noon.\n"
+	 "static inline void\n%s_event(unsigned long *n, bool *has, bool *up, int *minutes) {\n"
+	 "  int v = %s_nibble((*n)++);\n"
+	 "  *up = false;\n"
+	 "  if (v == %d) {\n"
+	 "    v = %s_nibble(*n) << 8 | %s_nibble(*n + 1) << 4 | %s_nibble(*n + 2);\n"
+	 "    *n += 3;\n"
+	 "    *has = v < 0x%x;\n"
+	 "    *up = v == 0x%x;\n"
+	 "    if (*has)\n"
+	 "      *minutes = v - %d;\n"
+	 "  } else {\n"
+	 "    *has = true;\n"
+	 "    *minutes += v & 1 ? -(v + 1) / 2 : v / 2;\n"
+	 "  }\n}\n\n",
+	 name, name, ESCAPE, name, name, name, NO_EVENT_DOWN, NO_EVENT_UP, ABSOLUTE_BIAS);
+
+  printf("static inline bool\n%s_day(long day, bool *hasRise, time_t *riseTime,\n"
+	 "\t\tbool *hasSet, time_t *setTime, bool *upAllDay) {\n"
+	 "  if (day < %s_firstDay || day >= %s_firstDay + %s_days)\n"
+	 "    return(false);\n"
+	 "  long i = day - %s_firstDay;\n"
+	 "  unsigned long n = %s(&%s_index[i / %d]);\n"
+	 "  int rise = 0, set = 0;\n"
+	 "  bool riseUp = false, setUp = false;\n"
+	 "  for (long k = i - i %% %d; k <= i; k++) {\n"
+	 "    %s_event(&n, hasRise, &riseUp, &rise);\n"
+	 "    %s_event(&n, hasSet, &setUp, &set);\n"
+	 "  }\n"
+	 "  time_t noon = day * 86400L + %s_noonOffset;\n"
+	 "  *riseTime = *hasRise ? noon + rise * 60L : 0;\n"
+	 "  *setTime = *hasSet ? noon + set * 60L : 0;\n"
+	 "  *upAllDay = !*hasRise && !*hasSet && riseUp;\n"
+	 "  return(true);\n}\n\n",
+	 name, name, name, name, name,
+	 nibbles.size() < 65536 ? "pgm_read_word" : "pgm_read_dword", name, BLOCK_DAYS,
+	 BLOCK_DAYS, name, name, name);
+
+  printf("#endif\n");
+  fprintf(stderr, "%ld days: %zu bytes data, %zu bytes index\n", days,
+	  nibbles.size() / 2, index.size() * (nibbles.size() < 65536 ? 2 : 4));
+  return(0);
+}
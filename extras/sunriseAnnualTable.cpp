@@ -0,0 +1,42 @@
+/*
+ * Generate SunRiseAnnualTable.h, the table of the sun's position through one
+ * tropical year used by SunRiseAnnual.
+ *
+ * Usage: sunriseAnnualTable > ../SunRiseAnnualTable.h
+ *
+ * Each entry holds the declination, and the right ascension less the mean
+ * sun's longitude, in thousandths of a degree, at evenly spaced phases of the
+ * tropical year from the start of a year counted from Jan 1, 2000, 1200UTC.
+ * The year is taken near the middle of the range of dates the table serves.
+ *
+ * Build:  g++ -O2 -I.. sunriseAnnualTable.cpp
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#include "SunRiseKernel.h"
+#include "SunRiseAnnual.h"
+
+#define TABLE_YEAR	25	    // Years from 2000.
+
+int
+main() {
+  printf("// Sun position through one tropical year for SunRiseAnnual.\n"
+	 "// Generated by extras/sunriseAnnualTable; do not edit.\n"
+	 "//\n"
+	 "// { declination, right ascension - mean longitude } in 0.001 degree.\n\n"
+	 "static const int16_t sunAnnualTable[SR_ANNUAL_ENTRIES][2] PROGMEM = {");
+
+  for (int i = 0; i < SR_ANNUAL_ENTRIES; i++) {
+    double d = ((double)i / SR_ANNUAL_ENTRIES + TABLE_YEAR) * SR_TROPICAL_YEAR;
+    SunRiseCoordinates sc = SunRiseSeries<SunRiseLibMath>::position(d);
+    double offset = sc.RA * 180 / M_PI - SR_MEAN_LONGITUDE(d);
+
+    offset -= 360 * floor((offset + 180) / 360);
+    printf("%s{ %6ld, %5ld },", i % 4 ? " " : "\n  ",
+	   lround(sc.declination * 180 / M_PI * 1000), lround(offset * 1000));
+  }
+  printf("\n};\n");
+  return(0);
+}
@@ -0,0 +1,91 @@
+/*
+ * Generate SunRiseAutoTable.h, the errors and costs of the engines from which
+ * SunRiseAuto chooses.
+ *
+ * Usage: sunriseAutoTable > SunRiseAutoTable.h
+ *
+ * The errors are those SunRiseAuto measures itself for 5 degree bands of
+ * latitude with 500 samples in each, which are repeatable.  The costs are
+ * timed here over the same number of samples, and given relative to
+ * SunRise::calculate() so that the order they put the engines in holds from
+ * one machine to another.
+ *
+ * Build:  g++ -O2 -std=c++14 -I.. sunriseAutoTable.cpp SunRiseAuto.cpp \
+ *	   SunHourAngleTable.cpp ../SunRise.cpp ../SunRiseAnnual.cpp ../SunRisePrecise.cpp
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#include "SunRiseAuto.h"
+
+#define BAND_DEGREES	5
+#define SAMPLES		500
+#define REPEATS		5	    // Timings kept: the fastest of these.
+
+static double
+now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+int
+main() {
+  SunRiseAuto measured(BAND_DEGREES, SAMPLES);
+  int bands = (int)ceil(180.0 / BAND_DEGREES);
+  double seconds[SunRiseAuto::engines];
+
+  fprintf(stderr, "timing engines\n");
+  for (int e = 0; e < SunRiseAuto::engines; e++) {
+    seconds[e] = HUGE_VAL;
+    for (int r = 0; r < REPEATS; r++) {
+      unsigned long long state = 1;
+      SunRise sr;
+      double start = now();
+
+      for (int i = 0; i < bands * SAMPLES; i++) {
+	state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+	double latitude = (double)(state >> 11) / 9007199254740992.0 * 180 - 90;
+	double longitude = (double)(state >> 20 & 0xffff) / 65536 * 360 - 180;
+	time_t t = 946684800L + (time_t)(state >> 34);
+	measured.run((SunRiseAuto::Engine)e, &sr, latitude, longitude, t);
+      }
+      seconds[e] = fmin(seconds[e], now() - start);
+    }
+  }
+
+  printf("// Errors and costs of the SunRiseAuto engines.\n"
+	 "// Generated by extras/sunriseAutoTable; do not edit.\n"
+	 "//\n"
+	 "// The largest error in seconds found in each %d degree band of latitude\n"
+	 "// from the south pole, for each engine but SunRisePrecise, and the cost of\n"
+	 "// a query relative to SunRise::calculate().\n\n", BAND_DEGREES);
+  printf("#define SR_AUTO_BAND_DEGREES\t%d\n#define SR_AUTO_BANDS\t\t%d\n\n",
+	 BAND_DEGREES, bands);
+
+  printf("static const float sunAutoErrors[%d][SR_AUTO_BANDS] = {",
+	 SunRiseAuto::precise);
+  for (int e = 0; e < SunRiseAuto::precise; e++) {
+    printf("\n  // %s\n  {", SunRiseAuto::name((SunRiseAuto::Engine)e));
+    for (int b = 0; b < bands; b++) {
+      double error = measured.error((SunRiseAuto::Engine)e,
+				    -90 + (b + 0.5) * BAND_DEGREES);
+      if (isinf(error))
+	printf("%sINFINITY,", b % 8 ? " " : "\n    ");
+      else
+	printf("%s%.0f,", b % 8 ? " " : "\n    ", error);
+    }
+    printf("\n  },");
+  }
+  printf("\n};\n\n");
+
+  printf("static const float sunAutoCosts[%d] = {\n", SunRiseAuto::engines);
+  for (int e = 0; e < SunRiseAuto::engines; e++)
+    printf("  %.3f,\t\t// %s\n", seconds[e] / seconds[SunRiseAuto::scanning],
+	   SunRiseAuto::name((SunRiseAuto::Engine)e));
+  printf("};\n");
+  return(0);
+}
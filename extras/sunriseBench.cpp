@@ -0,0 +1,176 @@
+/*
+ * Benchmark the ways of calculating sun rise and set events.
+ *
+ * Usage: sunriseBench [iterations]
+ *
+ * Each engine is run over the same pseudo-random times, and its cost per
+ * query is reported in nanoseconds (and in cycles on x86), along with the
+ * largest difference of its event times from SunRise::calculate().  Results
+ * that disagree on whether the sun is up, or on whether it rises or sets, are
+ * counted as mismatched; near an event this may be either engine's error of a
+ * few seconds.  SunRisePrecise's differences are mostly the reference's error.
+ *
+ * Then SunRise::calculateDay() is compared with SunRise::calculate() at local
+ * noon, the way SunEventSeries and sunriseAlmanac find each day's events, for
+ * consecutive local days (one per query, up to 100 years).
+ *
+ * Build:
+ *
+ *	g++ -O2 -std=c++14 -I.. sunriseBench.cpp SunHourAngleTable.cpp SunRiseAuto.cpp \
+ *	    ../SunRise.cpp ../SunRiseAnnual.cpp ../SunRisePrecise.cpp
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+
+#include "SunRise.h"
+#include "SunRiseFixed.h"
+#include "SunRiseAnnual.h"
+#include "SunRisePrecise.h"
+#include "SunHourAngleTable.h"
+#include "SunRiseAuto.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#else
+#define CYCLES() 0ULL
+#endif
+
+#define LATITUDE    42
+#define LONGITUDE   -90
+
+struct Site {
+  static constexpr double latitude = LATITUDE;
+  static constexpr double longitude = LONGITUDE;
+};
+
+static std::vector<time_t> times;
+static std::vector<SunRise> reference;
+
+static double
+now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+// Run an engine over every time, then report its cost and its largest
+// difference from the reference results.
+template <class Engine>
+static void
+bench(const char *name, Engine engine) {
+  std::vector<SunRise> results(times.size());
+  double start = now();
+  unsigned long long cycles = CYCLES();
+
+  for (size_t i = 0; i < times.size(); i++)
+    engine(&results[i], times[i]);
+
+  cycles = CYCLES() - cycles;
+  double elapsed = now() - start;
+  long worst = 0, mismatched = 0;
+
+  for (size_t i = 0; i < times.size(); i++) {
+    const SunRise &a = reference[i], &b = results[i];
+    if (a.isVisible != b.isVisible || a.hasRise != b.hasRise || a.hasSet != b.hasSet) {
+      mismatched++;
+      continue;
+    }
+    if (a.hasRise && labs((long)(a.riseTime - b.riseTime)) > worst)
+      worst = labs((long)(a.riseTime - b.riseTime));
+    if (a.hasSet && labs((long)(a.setTime - b.setTime)) > worst)
+      worst = labs((long)(a.setTime - b.setTime));
+  }
+  printf("%-24s %8.0f ns %8.0f cycles  max error %4ld s  %ld mismatched\n", name,
+	 elapsed / times.size() * 1e9, (double)cycles / times.size(), worst, mismatched);
+}
+
+// Compare SunRise::calculateDay() with calculate() at local noon over
+// consecutive local days.
+static void
+benchDaily(long days) {
+  std::vector<SunRise> noon(days), day(days);
+  time_t first = 1600041600L - (time_t)(LONGITUDE / 15 * 3600);  // Local midnight
+  double elapsed[2];
+
+  for (int e = 0; e < 2; e++) {
+    double start = now();
+    for (long i = 0; i < days; i++) {
+      time_t t = first + i * 86400;
+      if (e == 0)
+	noon[i].calculate(LATITUDE, LONGITUDE, t + 43200);
+      else
+	day[i].calculateDay(LATITUDE, LONGITUDE, t);
+    }
+    elapsed[e] = now() - start;
+  }
+
+  long worst = 0, mismatched = 0;
+  for (long i = 0; i < days; i++) {
+    time_t t = first + i * 86400;
+    const SunRise &a = noon[i], &b = day[i];
+    bool rise = a.hasRise && a.riseTime >= t && a.riseTime < t + 86400;
+    bool set = a.hasSet && a.setTime >= t && a.setTime < t + 86400;
+    if (rise != b.hasRise || set != b.hasSet) {
+      mismatched++;
+      continue;
+    }
+    if (rise && labs((long)(a.riseTime - b.riseTime)) > worst)
+      worst = labs((long)(a.riseTime - b.riseTime));
+    if (set && labs((long)(a.setTime - b.setTime)) > worst)
+      worst = labs((long)(a.setTime - b.setTime));
+  }
+  printf("\n%ld local days\n", days);
+  printf("%-24s %8.0f ns\n", "calculate at noon", elapsed[0] / days * 1e9);
+  printf("%-24s %8.0f ns %17s  max error %4ld s  %ld mismatched\n", "calculateDay",
+	 elapsed[1] / days * 1e9, "", worst, mismatched);
+}
+
+int
+main(int argc, char *argv[]) {
+  long iterations = argc > 1 ? atol(argv[1]) : 100000;
+
+  srand48(1);
+  for (long i = 0; i < iterations; i++)
+    times.push_back(1600000000L + (time_t)(drand48() * 3e8));
+  reference.resize(times.size());
+  for (size_t i = 0; i < times.size(); i++)
+    reference[i].calculate(LATITUDE, LONGITUDE, times[i]);
+
+  printf("%ld queries at latitude %g longitude %g\n", iterations,
+	 (double)LATITUDE, (double)LONGITUDE);
+  bench("SunRise::calculate", [](SunRise *sr, time_t t) {
+    sr->calculate(LATITUDE, LONGITUDE, t);
+  });
+  bench("SunRiseFixed", [](SunRise *sr, time_t t) {
+    SunRiseFixed<Site> fixed;
+    fixed.calculate(t);
+    *sr = fixed;
+  });
+  bench("SunRiseAnnual", [](SunRise *sr, time_t t) {
+    SunRiseAnnual annual;
+    annual.calculate(LATITUDE, LONGITUDE, t);
+    *sr = annual;
+  });
+  bench("SunRisePrecise", [](SunRise *sr, time_t t) {
+    SunRisePrecise precise;
+    precise.calculate(LATITUDE, LONGITUDE, t);
+    *sr = precise;
+  });
+
+  static SunHourAngleTable table;
+  bench("SunHourAngleTable", [](SunRise *sr, time_t t) {
+    table.calculate(sr, LATITUDE, LONGITUDE, t);
+  });
+
+  static SunRiseAuto automatic;
+  bench("SunRiseAuto, 60 s", [](SunRise *sr, time_t t) {
+    automatic.calculate(sr, LATITUDE, LONGITUDE, t, 60);
+  });
+
+  benchDaily(iterations < 36525 ? iterations : 36525);
+  return(0);
+}
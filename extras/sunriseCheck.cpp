@@ -0,0 +1,132 @@
+/*
+ * Check cases that the other tools do not exercise.  Prints each failure and
+ * exits non-zero if there are any.
+ *
+ * Usage: sunriseCheck
+ *
+ * Build:  g++ -O2 -I.. sunriseCheck.cpp SunRuleEngine.cpp SunEventSeries.cpp \
+ *	   ../SunRise.cpp
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "SunRise.h"
+#include "SunRiseFixed.h"
+#include "SunEventSeries.h"
+#include "SunLocalDay.h"
+#include "SunRuleEngine.h"
+
+static int failures;
+
+static void
+check(bool ok, const char *what) {
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+// A rule with a large negative offset, evaluated after its anchor event: the
+// activation comes from an event nearly two days away.
+static void
+checkNegativeOffset() {
+  SunRuleEngine engine;
+  SunRise sr;
+  time_t june = 1718409600;		    // 2024-06-15 00:00 UTC
+
+  sr.calculate(42, -71, june);
+  time_t now = sr.setTime + 3 * 3600;	    // Three hours after sunset.
+
+  size_t site = engine.addSite(42, -71, -4 * 3600);
+  long before = engine.addRule(site, "sunset-23h");
+  long span = engine.addRule(site, "sunset-23h until sunrise+23h");
+  std::vector<SunRuleEngine::Activation> next;
+  engine.evaluate(now, &next);
+
+  const SunRuleEngine::Activation &a = next[before];
+  check(a.hasStart, "sunset-23h after sunset has a start");
+  check(a.hasStart && a.start > now + 20 * 3600 && a.start < now + 23 * 3600,
+	"sunset-23h after sunset starts about 22 hours later");
+  sr.calculate(42, -71, a.start + 23 * 3600);
+  check(sr.hasSet && labs((long)(sr.setTime - (a.start + 23 * 3600))) < 60,
+	"sunset-23h is 23 hours before a sunset");
+
+  const SunRuleEngine::Activation &b = next[span];
+  check(b.hasStart && b.start == a.start, "sunset-23h until ... starts with sunset-23h");
+  check(b.hasEnd && b.end > b.start, "sunrise+23h ends after the start");
+  sr.calculate(42, -71, b.end - 23 * 3600);
+  check(sr.hasRise && labs((long)(sr.riseTime - (b.end - 23 * 3600))) < 60,
+	"sunrise+23h is 23 hours after a sunrise");
+}
+
+// A series inside the arctic circle gives each day's events within that day,
+// and refuses damaged data rather than reading past it.
+static void
+checkSeries() {
+  std::vector<uint8_t> buf;
+  SunEventSeries series;
+  SunEventSeries::Day d;
+  long first = 19723;			    // 2024-01-01
+  bool inDay = true;
+
+  check(SunEventSeries::encode(69.6, 18.9, first, 366, &buf, 16) &&
+	series.open(buf.data(), buf.size()), "series opens");
+  for (long day = first; day < first + 366; day++) {
+    time_t midnight = sunLocalMidnight(day, 18.9);
+    if (!series.day(day, &d) ||
+	(d.hasRise && (d.riseTime < midnight - 30 || d.riseTime > midnight + 86430)) ||
+	(d.hasSet && (d.setTime < midnight - 30 || d.setTime > midnight + 86430)))
+      inDay = false;
+  }
+  check(inDay, "series events fall within their local day");
+
+  // Skip the magic and five varints of the header to reach the index, and
+  // point the last block past the end.
+  std::vector<uint8_t> bad(buf);
+  size_t index = 4;
+  for (int field = 0; field < 5; index++)
+    if (!(bad[index] & 0x80))
+      field++;
+  bad[index + 4 * 22 + 3] = 0x7f;
+  check(series.open(bad.data(), bad.size()) && !series.day(first + 365, &d),
+	"series block offset past the end is refused");
+  check(!series.open(buf.data(), index + 8), "series with a truncated index is refused");
+}
+
+struct FixedSite {
+  static constexpr double latitude = 69.6;
+  static constexpr double longitude = 18.9;
+};
+
+// SunRiseFixed, whose constants are computed by the compiler, agrees with
+// calculate() to within rounding, here inside the arctic circle through a year.
+static void
+checkFixed() {
+  SunRiseFixed<FixedSite> fixed;
+  SunRise sr;
+  bool agree = true;
+
+  for (time_t t = 1704067200; t < 1704067200 + 366 * 86400L; t += 3571) {
+    fixed.calculate(t);
+    sr.calculate(FixedSite::latitude, FixedSite::longitude, t);
+    if (fixed.hasRise != sr.hasRise || fixed.hasSet != sr.hasSet ||
+	fixed.isVisible != sr.isVisible ||
+	(sr.hasRise && labs((long)(fixed.riseTime - sr.riseTime)) > 1) ||
+	(sr.hasSet && labs((long)(fixed.setTime - sr.setTime)) > 1))
+      agree = false;
+  }
+  check(agree, "SunRiseFixed agrees with calculate() to a second");
+}
+
+int
+main() {
+  checkNegativeOffset();
+  checkSeries();
+  checkFixed();
+  if (failures == 0)
+    printf("all checks passed\n");
+  return(failures != 0);
+}
@@ -0,0 +1,158 @@
+/*
+ * Count the instructions executed by each feature of the engine.
+ *
+ * Usage: sunriseCycles [budget]
+ *
+ * Hardware performance counters are often unavailable (in virtual machines,
+ * containers and CI runners), so instructions are counted by single-stepping
+ * a traced child process through each feature with ptrace().  The counts are
+ * for the host instruction set; they track changes in the work done rather
+ * than predict cycles on a particular board.  An empty region is measured
+ * first and its count subtracted from the others.
+ *
+ * If a budget is given, the exit status is 1 when SunRise::calculate() takes
+ * more instructions than the budget.
+ *
+ * Linux only.  Build:
+ *
+ *	g++ -O2 -std=c++14 -I.. sunriseCycles.cpp ../SunRise.cpp ../SunRiseAnnual.cpp \
+ *	    ../SunRisePrecise.cpp
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+
+#include "SunRise.h"
+#include "SunRiseFixed.h"
+#include "SunRiseAnnual.h"
+#include "SunRisePrecise.h"
+
+struct Site {
+  static constexpr double latitude = 42;
+  static constexpr double longitude = -90;
+};
+
+static volatile time_t when = 1700000000;
+static volatile double latitude = Site::latitude, longitude = Site::longitude;
+
+static void
+featureEmpty() {
+}
+
+static void
+featureCalculate() {
+  SunRise sr;
+  sr.calculate(latitude, longitude, when);
+}
+
+static void
+featureFixed() {
+  SunRiseFixed<Site> sr;
+  sr.calculate(when);
+}
+
+static void
+featureAnnual() {
+  SunRiseAnnual sr;
+  sr.calculate(latitude, longitude, when);
+}
+
+static void
+featurePrecise() {
+  SunRisePrecise sr;
+  sr.calculate(latitude, longitude, when);
+}
+
+static void
+featureDay() {
+  SunRise sr;
+  sr.calculateDay(latitude, longitude, when);
+}
+
+static void
+featurePack() {
+  static SunRise sr;
+  SunRisePacked p;
+  sr.pack(&p);
+  sr.unpack(&p);
+}
+
+struct Feature {
+  const char *name;
+  void (*run)();
+};
+
+static const Feature features[] = {
+  { "empty", featureEmpty },
+  { "SunRise::calculate", featureCalculate },
+  { "SunRiseFixed::calculate", featureFixed },
+  { "SunRiseAnnual::calculate", featureAnnual },
+  { "SunRisePrecise::calculate", featurePrecise },
+  { "SunRise::calculateDay", featureDay },
+  { "pack + unpack", featurePack },
+};
+#define FEATURES (int)(sizeof(features) / sizeof(features[0]))
+
+// In the child: mark the start and end of each feature with signals the
+// tracer intercepts.
+static void
+child() {
+  ptrace(PTRACE_TRACEME, 0, NULL, NULL);
+  for (int i = 0; i < FEATURES; i++) {
+    features[i].run();		    // Warm up lazy binding and caches.
+    raise(SIGUSR1);
+    features[i].run();
+    raise(SIGUSR2);
+  }
+  _exit(0);
+}
+
+int
+main(int argc, char *argv[]) {
+  long budget = argc > 1 ? atol(argv[1]) : 0;
+  long counts[FEATURES];
+  int status, f = 0;
+
+  pid_t pid = fork();
+  if (pid == 0)
+    child();
+
+  while (f < FEATURES && waitpid(pid, &status, 0) == pid && WIFSTOPPED(status)) {
+    if (WSTOPSIG(status) != SIGUSR1) {
+      ptrace(PTRACE_CONT, pid, NULL, NULL);
+      continue;
+    }
+    // Step until the end marker, without delivering either signal.
+    long steps = 0;
+    for (;;) {
+      if (ptrace(PTRACE_SINGLESTEP, pid, NULL, NULL) < 0 ||
+	  waitpid(pid, &status, 0) != pid || !WIFSTOPPED(status)) {
+	perror("ptrace");
+	return(2);
+      }
+      if (WSTOPSIG(status) == SIGUSR2)
+	break;
+      steps++;
+    }
+    counts[f++] = steps;
+    ptrace(PTRACE_CONT, pid, NULL, NULL);
+  }
+  if (f < FEATURES) {
+    fprintf(stderr, "instruction counting unavailable (ptrace not permitted?)\n");
+    return(2);
+  }
+  waitpid(pid, &status, 0);
+
+  for (int i = 1; i < FEATURES; i++)
+    printf("%-24s %8ld instructions\n", features[i].name, counts[i] - counts[0]);
+
+  if (budget > 0 && counts[1] - counts[0] > budget) {
+    printf("SunRise::calculate exceeds budget of %ld instructions\n", budget);
+    return(1);
+  }
+  return(0);
+}
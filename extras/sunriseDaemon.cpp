@@ -0,0 +1,231 @@
+/*
+ * Linux daemon announcing sun rise, set and twilight events over a Unix domain
+ * socket.
+ *
+ * Usage: sunriseDaemon sites-file socket-path
+ *
+ * The sites file holds one "latitude longitude" pair per line, in decimal
+ * degrees, optionally followed by any of the words civil, nautical and
+ * astronomical to also announce the beginning and end of that twilight.
+ * Lines beginning with '#' are ignored.  Sites are numbered from zero in the
+ * order they appear.
+ *
+ * Each client connecting to the socket receives one line per event:
+ *
+ *	site event unix-time azimuth
+ *
+ * where event is rise or set, or civil-dawn, civil-dusk, nautical-dawn,
+ * nautical-dusk, astronomical-dawn or astronomical-dusk.
+ *
+ * The daemon sleeps on a timerfd armed for the earliest pending event of the
+ * SunEventScheduler, so no work is done between events.
+ *
+ * Build:  g++ -O2 -I.. -I. sunriseDaemon.cpp SunEventScheduler.cpp ../SunRise.cpp
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <vector>
+
+#include "SunEventScheduler.h"
+
+// The event names for each kind, rise (dawn) first.
+static const char *const eventNames[][2] = {
+  { "rise", "set" },
+  { "civil-dawn", "civil-dusk" },
+  { "nautical-dawn", "nautical-dusk" },
+  { "astronomical-dawn", "astronomical-dusk" },
+};
+
+// What the scheduler's callback announces to: the connected clients, and the
+// site number and kind of each scheduler entry.
+struct Daemon {
+  std::vector<int> clients;
+  std::vector<size_t> sites;
+  std::vector<SunEventScheduler::Kind> kinds;
+};
+
+static void
+dropClient(Daemon *d, size_t i) {
+  close(d->clients[i]);
+  d->clients.erase(d->clients.begin() + i);
+}
+
+// Write an event to every connected client, dropping those that have gone.
+static void
+announce(void *context, size_t entry, SunEventScheduler::EventType type,
+	 time_t eventTime, float azimuth) {
+  Daemon *d = (Daemon *)context;
+  char line[128];
+  int n = snprintf(line, sizeof(line), "%zu %s %ld %.2f\n", d->sites[entry],
+		   eventNames[d->kinds[entry]][type == SunEventScheduler::setEvent],
+		   (long)eventTime, azimuth);
+
+  for (size_t i = 0; i < d->clients.size(); ) {
+    if (send(d->clients[i], line, n, MSG_NOSIGNAL | MSG_DONTWAIT) != n)
+      dropClient(d, i);
+    else
+      i++;
+  }
+}
+
+static void
+addEntry(Daemon *d, SunEventScheduler *sched, size_t site, double latitude,
+	 double longitude, SunEventScheduler::Kind kind) {
+  sched->addSite(latitude, longitude, kind);
+  d->sites.push_back(site);
+  d->kinds.push_back(kind);
+}
+
+static int
+loadSites(Daemon *d, SunEventScheduler *sched, const char *path) {
+  FILE *f = fopen(path, "r");
+  char line[256];
+  int count = 0;
+
+  if (f == NULL)
+    return(-1);
+  while (fgets(line, sizeof(line), f) != NULL) {
+    double latitude, longitude;
+    int used;
+    if (line[0] == '#' ||
+	sscanf(line, "%lf %lf%n", &latitude, &longitude, &used) != 2)
+      continue;
+    addEntry(d, sched, count, latitude, longitude, SunEventScheduler::sunEvents);
+    for (char *word = strtok(line + used, " \t\r\n"); word != NULL;
+	 word = strtok(NULL, " \t\r\n")) {
+      if (strcmp(word, "civil") == 0)
+	addEntry(d, sched, count, latitude, longitude, SunEventScheduler::civilTwilight);
+      else if (strcmp(word, "nautical") == 0)
+	addEntry(d, sched, count, latitude, longitude, SunEventScheduler::nauticalTwilight);
+      else if (strcmp(word, "astronomical") == 0)
+	addEntry(d, sched, count, latitude, longitude,
+		 SunEventScheduler::astronomicalTwilight);
+    }
+    count++;
+  }
+  fclose(f);
+  return(count);
+}
+
+static int
+listenSocket(const char *path) {
+  struct sockaddr_un addr;
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+  if (fd < 0)
+    return(-1);
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  unlink(path);
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+    close(fd);
+    return(-1);
+  }
+  return(fd);
+}
+
+// Arm the timer for the next event, or disarm it if there is none.  The timer
+// is cancelled if the clock is set, so a step does not leave the daemon
+// sleeping to a deadline computed against the old time.
+static void
+armTimer(int tfd, SunEventScheduler *sched) {
+  struct itimerspec its;
+  time_t deadline = sched->nextDeadline();
+
+  memset(&its, 0, sizeof(its));
+  if (deadline >= 0)
+    its.it_value.tv_sec = deadline > 0 ? deadline : 1;
+  timerfd_settime(tfd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &its, NULL);
+}
+
+int
+main(int argc, char *argv[]) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s sites-file socket-path\n", argv[0]);
+    return(1);
+  }
+
+  Daemon daemon;
+  SunEventScheduler sched(time(NULL), announce, &daemon);
+  int count = loadSites(&daemon, &sched, argv[1]);
+  if (count < 0) {
+    fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+    return(1);
+  }
+
+  int lfd = listenSocket(argv[2]);
+  if (lfd < 0) {
+    fprintf(stderr, "%s: %s\n", argv[2], strerror(errno));
+    return(1);
+  }
+
+  int tfd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+  int efd = epoll_create1(EPOLL_CLOEXEC);
+  struct epoll_event ev;
+
+  ev.events = EPOLLIN;
+  ev.data.fd = tfd;
+  epoll_ctl(efd, EPOLL_CTL_ADD, tfd, &ev);
+  ev.data.fd = lfd;
+  epoll_ctl(efd, EPOLL_CTL_ADD, lfd, &ev);
+
+  signal(SIGPIPE, SIG_IGN);
+  fprintf(stderr, "%d sites, %zu events pending\n", count, sched.pending());
+  armTimer(tfd, &sched);
+
+  for (;;) {
+    struct epoll_event events[8];
+    int n = epoll_wait(efd, events, 8, -1);
+
+    if (n < 0 && errno != EINTR)
+      break;
+    for (int i = 0; i < n; i++) {
+      int fd = events[i].data.fd;
+
+      if (fd == tfd) {
+	// ECANCELED means the clock was set: catch up and re-arm from the new
+	// time as for an expiry.
+	uint64_t expirations;
+	if (read(tfd, &expirations, sizeof(expirations)) < 0 &&
+	    errno != EAGAIN && errno != ECANCELED)
+	  continue;
+	sched.advance(time(NULL));
+	armTimer(tfd, &sched);
+      } else if (fd == lfd) {
+	int cfd = accept4(lfd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+	if (cfd < 0)
+	  continue;
+	ev.events = EPOLLIN | EPOLLRDHUP;
+	ev.data.fd = cfd;
+	epoll_ctl(efd, EPOLL_CTL_ADD, cfd, &ev);
+	daemon.clients.push_back(cfd);
+      } else {
+	// Clients have nothing to say; anything they send is discarded, and a
+	// hangup or error drops them at once rather than at the next event.
+	char buf[256];
+	ssize_t got;
+	while ((got = read(fd, buf, sizeof(buf))) > 0)
+	  ;
+	if (got == 0 || (events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) ||
+	    (errno != EAGAIN && errno != EWOULDBLOCK)) {
+	  for (size_t c = 0; c < daemon.clients.size(); c++)
+	    if (daemon.clients[c] == fd) {
+	      dropClient(&daemon, c);
+	      break;
+	    }
+	}
+      }
+    }
+  }
+  return(1);
+}
@@ -0,0 +1,139 @@
+/*
+ * Compute the horizon profiles of a set of sites from a terrain grid, and
+ * write them as a cache for SunHorizonProfile.
+ *
+ * Usage: sunriseHorizon [-b] [-j threads] [-n azimuths] [-r range-km]
+ *			 dem-file columns rows west north spacing sites-file cache-file
+ *
+ * The terrain grid is a raw file of 16 bit heights in metres, little endian
+ * (big endian with -b, as in SRTM .hgt files), a row at a time from north to
+ * south.  West and north are the longitude and latitude of the first sample,
+ * and spacing the degrees between samples; a 1 arc second SRTM tile is 3601
+ * by 3601 samples, spacing 1/3600.  Voids (-32768) are filled from the
+ * samples around them.
+ *
+ * The sites file holds one "latitude longitude [height]" line per site, in
+ * decimal degrees, with the height of the observer above the ground in metres
+ * (default 2).  Sites outside the grid are reported and left out of the
+ * cache.  Profiles are found at the given number of azimuths (default
+ * 360) out to the given range (default 50 km), using the given number of
+ * threads (default one per processor).
+ *
+ * Build:  g++ -O2 -std=c++14 -pthread -I.. sunriseHorizon.cpp SunHorizonProfile.cpp
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "SunHorizonProfile.h"
+
+static double
+now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+static void
+usage() {
+  fprintf(stderr, "usage: sunriseHorizon [-b] [-j threads] [-n azimuths] [-r range-km]\n"
+		  "\t\t      dem-file columns rows west north spacing sites-file cache-file\n");
+  exit(2);
+}
+
+int
+main(int argc, char *argv[]) {
+  bool bigEndian = false;
+  int threads = 0, azimuths = 360;
+  double range = 50;
+  int c;
+
+  while ((c = getopt(argc, argv, "bj:n:r:")) != -1) {
+    switch (c) {
+      case 'b': bigEndian = true; break;
+      case 'j': threads = atoi(optarg); break;
+      case 'n': azimuths = atoi(optarg); break;
+      case 'r': range = atof(optarg); break;
+      default: usage();
+    }
+  }
+  argc -= optind;
+  argv += optind;
+  if (argc != 8 || azimuths < 1 || azimuths > 0xffff || range <= 0)
+    usage();
+
+  SunHorizonProfile::Elevation dem;
+  dem.columns = atoi(argv[1]);
+  dem.rows = atoi(argv[2]);
+  dem.west = atof(argv[3]);
+  dem.north = atof(argv[4]);
+  dem.spacing = atof(argv[5]);
+  if (dem.columns < 2 || dem.rows < 2 || dem.spacing <= 0)
+    usage();
+
+  FILE *f = fopen(argv[0], "rb");
+  if (f == NULL) {
+    perror(argv[0]);
+    return(1);
+  }
+  std::vector<int16_t> heights((size_t)dem.columns * dem.rows);
+  std::vector<uint8_t> raw(heights.size() * 2);
+  size_t got = fread(raw.data(), 1, raw.size(), f);
+  fclose(f);
+  if (got != raw.size()) {
+    fprintf(stderr, "%s: expected %zu bytes, read %zu\n", argv[0], raw.size(), got);
+    return(1);
+  }
+  for (size_t i = 0; i < heights.size(); i++) {
+    uint8_t lo = raw[2 * i], hi = raw[2 * i + 1];
+    heights[i] = bigEndian ? (int16_t)(lo << 8 | hi) : (int16_t)(hi << 8 | lo);
+  }
+  long voids = SunHorizonProfile::fillVoids(heights.data(), dem.columns, dem.rows);
+  if (voids > 0)
+    fprintf(stderr, "%s: filled %ld voids\n", argv[0], voids);
+  dem.height = heights.data();
+
+  if ((f = fopen(argv[6], "r")) == NULL) {
+    perror(argv[6]);
+    return(1);
+  }
+  std::vector<SunHorizonProfile::Site> sites;
+  char line[256];
+  for (int n = 1; fgets(line, sizeof(line), f) != NULL; n++) {
+    SunHorizonProfile::Site s = { 0, 0, 2 };
+    if (sscanf(line, "%lf %lf %lf", &s.latitude, &s.longitude, &s.height) < 2)
+      continue;
+    if (SunHorizonProfile::covers(dem, s))
+      sites.push_back(s);
+    else
+      fprintf(stderr, "%s:%d: %g %g is outside the terrain grid, skipped\n",
+	      argv[6], n, s.latitude, s.longitude);
+  }
+  fclose(f);
+  if (sites.empty())
+    usage();
+
+  std::vector<float> altitudes;
+  double begin = now();
+  SunHorizonProfile::compute(dem, sites, azimuths, range * 1000, threads, &altitudes);
+  double elapsed = now() - begin;
+
+  std::vector<uint8_t> cache;
+  SunHorizonProfile::encode(sites, azimuths, altitudes, &cache);
+  if ((f = fopen(argv[7], "wb")) == NULL) {
+    perror(argv[7]);
+    return(1);
+  }
+  if (fwrite(cache.data(), 1, cache.size(), f) != cache.size() || fclose(f) != 0) {
+    perror(argv[7]);
+    return(1);
+  }
+
+  fprintf(stderr, "%zu sites, %d azimuths, %.2f s, %.0f bytes per site\n",
+	  sites.size(), azimuths, elapsed, (double)cache.size() / sites.size());
+  return(0);
+}
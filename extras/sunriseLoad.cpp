@@ -0,0 +1,163 @@
+/*
+ * Load generator for sunriseServer.
+ *
+ * Usage: sunriseLoad socket-path [connections [queries [depth]]]
+ *
+ * Opens the given number of connections (default 8), and on each sends the
+ * given number of queries (default 10000) for random locations and times,
+ * keeping up to depth (default 16) queries outstanding.  Reports throughput
+ * and the distribution of round trip latency.
+ *
+ * Build:  g++ -O2 sunriseLoad.cpp
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+struct Connection {
+  int fd;
+  long sent;
+  long received;
+  std::string in;
+  std::deque<struct timespec> outstanding;
+};
+
+static double
+seconds(const struct timespec *t) {
+  return(t->tv_sec + t->tv_nsec / 1e9);
+}
+
+static int
+connectSocket(const char *path) {
+  struct sockaddr_un addr;
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+  if (fd < 0)
+    return(-1);
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    return(-1);
+  }
+  return(fd);
+}
+
+// Send queries until depth are outstanding or all have been sent.
+static void
+fill(Connection *c, long queries, int depth) {
+  std::string out;
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  while (c->sent < queries && (int)c->outstanding.size() < depth) {
+    char line[80];
+    snprintf(line, sizeof(line), "%.4f %.4f %ld\n",
+	     drand48() * 180 - 90, drand48() * 360 - 180,
+	     1600000000L + (long)(drand48() * 3e8));
+    out += line;
+    c->outstanding.push_back(now);
+    c->sent++;
+  }
+  if (!out.empty() && write(c->fd, out.data(), out.size()) != (ssize_t)out.size()) {
+    perror("write");
+    exit(1);
+  }
+}
+
+int
+main(int argc, char *argv[]) {
+  if (argc < 2 || argc > 5) {
+    fprintf(stderr, "usage: %s socket-path [connections [queries [depth]]]\n", argv[0]);
+    return(1);
+  }
+  int connections = argc > 2 ? atoi(argv[2]) : 8;
+  long queries = argc > 3 ? atol(argv[3]) : 10000;
+  int depth = argc > 4 ? atoi(argv[4]) : 16;
+  if (connections <= 0 || queries <= 0 || depth <= 0) {
+    printf("no queries\n");
+    return(0);
+  }
+
+  std::vector<Connection> conns(connections);
+  std::vector<double> latencies;
+  int efd = epoll_create1(EPOLL_CLOEXEC);
+  struct timespec start, end;
+
+  srand48(1);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < connections; i++) {
+    Connection *c = &conns[i];
+    if ((c->fd = connectSocket(argv[1])) < 0) {
+      fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+      return(1);
+    }
+    c->sent = c->received = 0;
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u32 = i;
+    epoll_ctl(efd, EPOLL_CTL_ADD, c->fd, &ev);
+    fill(c, queries, depth);
+  }
+
+  int active = connections;
+  while (active > 0) {
+    struct epoll_event events[64];
+    int n = epoll_wait(efd, events, 64, -1);
+
+    for (int i = 0; i < n; i++) {
+      Connection *c = &conns[events[i].data.u32];
+      char buf[8192];
+      ssize_t len = read(c->fd, buf, sizeof(buf));
+      struct timespec now;
+
+      if (len <= 0) {
+	fprintf(stderr, "server closed connection\n");
+	return(1);
+      }
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      c->in.append(buf, len);
+
+      size_t start = 0, nl;
+      while ((nl = c->in.find('\n', start)) != std::string::npos) {
+	latencies.push_back(seconds(&now) - seconds(&c->outstanding.front()));
+	c->outstanding.pop_front();
+	c->received++;
+	start = nl + 1;
+      }
+      c->in.erase(0, start);
+
+      if (c->received == queries) {
+	epoll_ctl(efd, EPOLL_CTL_DEL, c->fd, NULL);
+	close(c->fd);
+	active--;
+      } else
+	fill(c, queries, depth);
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double elapsed = seconds(&end) - seconds(&start);
+  std::sort(latencies.begin(), latencies.end());
+  printf("%zu queries in %.3f s: %.0f queries/s\n", latencies.size(), elapsed,
+	 latencies.size() / elapsed);
+  printf("latency p50 %.0f us, p90 %.0f us, p99 %.0f us, max %.0f us\n",
+	 latencies[latencies.size() / 2] * 1e6,
+	 latencies[latencies.size() * 9 / 10] * 1e6,
+	 latencies[latencies.size() * 99 / 100] * 1e6,
+	 latencies.back() * 1e6);
+  return(0);
+}
@@ -0,0 +1,439 @@
+/*
+ * Sun rise/set query server on a Unix domain socket.
+ *
+ * Usage: sunriseServer socket-path [budget-microseconds [max-batch]]
+ *
+ * Clients write one query per line:
+ *
+ *	latitude longitude unix-time
+ *
+ * and receive one line per query, in order:
+ *
+ *	isVisible hasRise riseTime riseAz hasSet setTime setAz
+ *
+ * or "error" for a line that is not a query, or that is longer than 256
+ * characters.  A client that shuts down its side of the connection is
+ * answered before the server closes it.
+ *
+ * Queries arriving within the time budget (default 1000 microseconds) of the
+ * first query of a batch are answered together, up to max-batch (default 1024)
+ * queries.  Within a batch, identical queries are calculated once, and the
+ * sun's positions are found once for all the queries within an hour of each
+ * other, which then differ from SunRise::calculate() by a second at most.
+ * Latency and throughput statistics, with the number of queries calculated
+ * per set of the sun's positions, are written to stderr every ten seconds.
+ *
+ * See sunriseLoad.cpp for a load generator.
+ *
+ * Build:  g++ -O2 -I.. sunriseServer.cpp ../SunRise.cpp
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SunRiseKernel.h"
+
+#define STATS_INTERVAL	10	    // Seconds
+#define LATENCY_BUCKETS	32	    // Powers of two microseconds
+#define SKY_SECONDS	3600	    // Span of queries sharing the sun's positions
+#define MAX_LINE	256	    // Longest query line, in characters
+
+typedef SunRiseKernel<SunRiseLibMath> Kernel;
+
+struct Query {
+  int fd;
+  bool valid;		    // Otherwise answered with an error.
+  double latitude;
+  double longitude;
+  time_t t;
+  struct timespec arrival;
+};
+
+struct Client {
+  std::string in;
+  std::string out;
+  bool readClosed;	    // The client has sent all its queries.
+  bool skipping;	    // Discarding the rest of an overlong line.
+  bool watched;		    // Registered with epoll.
+};
+
+static std::map<int, Client> clients;
+static std::vector<Query> pending;
+static int efd;
+
+// Statistics since the last report.
+static unsigned long statQueries, statBatches, statComputed, statSkies;
+static unsigned long latency[LATENCY_BUCKETS];
+
+static long
+elapsedMicroseconds(const struct timespec *from, const struct timespec *to) {
+  return((to->tv_sec - from->tv_sec) * 1000000L + (to->tv_nsec - from->tv_nsec) / 1000);
+}
+
+static void
+recordLatency(long us) {
+  int b = 0;
+  while (b < LATENCY_BUCKETS - 1 && (1L << b) <= us)
+    b++;
+  latency[b]++;
+}
+
+// Upper bound of the latency bucket holding the given fraction of queries.
+static long
+latencyPercentile(double fraction) {
+  unsigned long total = 0, sum = 0;
+  for (int b = 0; b < LATENCY_BUCKETS; b++)
+    total += latency[b];
+  for (int b = 0; b < LATENCY_BUCKETS; b++) {
+    sum += latency[b];
+    if (sum >= fraction * total)
+      return(1L << b);
+  }
+  return(1L << (LATENCY_BUCKETS - 1));
+}
+
+static void
+reportStats() {
+  if (statQueries == 0)
+    return;
+  fprintf(stderr, "%lu queries/s, %lu batches, %.1f queries/batch, "
+	  "%.1f%% computed, %.1f computed/sky, latency p50 < %ld us, p99 < %ld us\n",
+	  statQueries / STATS_INTERVAL, statBatches,
+	  (double)statQueries / statBatches, 100.0 * statComputed / statQueries,
+	  statSkies ? (double)statComputed / statSkies : 0.0,
+	  latencyPercentile(0.5), latencyPercentile(0.99));
+  statQueries = statBatches = statComputed = statSkies = 0;
+  memset(latency, 0, sizeof(latency));
+}
+
+static void
+closeClient(int fd) {
+  if (clients[fd].watched)
+    epoll_ctl(efd, EPOLL_CTL_DEL, fd, NULL);
+  close(fd);
+  clients.erase(fd);
+  for (size_t i = 0; i < pending.size(); i++)
+    if (pending[i].fd == fd)
+      pending[i].fd = -1;
+}
+
+static bool
+hasPending(int fd) {
+  for (size_t i = 0; i < pending.size(); i++)
+    if (pending[i].fd == fd)
+      return(true);
+  return(false);
+}
+
+// Write as much buffered output as the socket accepts, and wait for it to
+// become writable if any remains.  A client that has sent all its queries is
+// closed once they have all been answered; until then it is watched only
+// while output remains, since epoll reports a hangup whatever is asked for.
+static void
+flushClient(int fd) {
+  Client &c = clients[fd];
+  while (!c.out.empty()) {
+    ssize_t n = send(fd, c.out.data(), c.out.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+	break;
+      closeClient(fd);
+      return;
+    }
+    c.out.erase(0, n);
+  }
+  if (c.readClosed && c.out.empty() && !hasPending(fd)) {
+    closeClient(fd);
+    return;
+  }
+
+  if (c.readClosed && c.out.empty()) {
+    if (c.watched)
+      epoll_ctl(efd, EPOLL_CTL_DEL, fd, NULL);
+    c.watched = false;
+    return;
+  }
+  struct epoll_event ev;
+  ev.events = (c.readClosed ? 0u : (uint32_t)EPOLLIN) |
+	      (c.out.empty() ? 0u : (uint32_t)EPOLLOUT);
+  ev.data.fd = fd;
+  epoll_ctl(efd, c.watched ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev);
+  c.watched = true;
+}
+
+static bool
+queryOrder(const Query *a, const Query *b) {
+  if (a->t != b->t)
+    return(a->t < b->t);
+  if (a->latitude != b->latitude)
+    return(a->latitude < b->latitude);
+  return(a->longitude < b->longitude);
+}
+
+// Answer every pending query.
+static void
+runBatch() {
+  std::vector<const Query *> order;
+  std::vector<SunRise> results(pending.size());
+  struct timespec now;
+  Kernel::Sky sky;
+  time_t skyEnd = 0;
+  bool shared = false;
+
+  if (pending.empty())
+    return;
+  for (size_t i = 0; i < pending.size(); i++)
+    if (pending[i].valid)
+      order.push_back(&pending[i]);
+  std::sort(order.begin(), order.end(), queryOrder);
+
+  // Identical queries are adjacent after sorting; calculate each only once.
+  // The queries within SKY_SECONDS of the first of a group share one sky,
+  // unless there is only one of them.
+  for (size_t i = 0; i < order.size(); i++) {
+    const Query *q = order[i];
+    SunRise *sr = &results[q - &pending[0]];
+    if (i > 0 && !queryOrder(order[i - 1], q)) {
+      *sr = results[order[i - 1] - &pending[0]];
+      continue;
+    }
+    if (i == 0 || q->t > skyEnd) {
+      size_t last = i;
+      while (last + 1 < order.size() && order[last + 1]->t < q->t + SKY_SECONDS)
+	last++;
+      skyEnd = order[last]->t;
+      shared = skyEnd > q->t || (last > i && queryOrder(q, order[last]));
+      if (shared)
+	Kernel::sky(&sky, q->t, skyEnd);
+      statSkies++;
+    }
+    if (shared)
+      Kernel::search(sr, Kernel::site(q->latitude, q->longitude), q->t, sky);
+    else
+      sr->calculate(q->latitude, q->longitude, q->t);
+    statComputed++;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  for (size_t i = 0; i < pending.size(); i++) {
+    const Query *q = &pending[i];
+    const SunRise *sr = &results[i];
+    char line[160];
+
+    if (q->fd < 0)
+      continue;
+    if (q->valid)
+      snprintf(line, sizeof(line), "%d %d %ld %.2f %d %ld %.2f\n",
+	       sr->isVisible, sr->hasRise, (long)sr->riseTime, sr->riseAz,
+	       sr->hasSet, (long)sr->setTime, sr->setAz);
+    else
+      strcpy(line, "error\n");
+    clients[q->fd].out += line;
+    recordLatency(elapsedMicroseconds(&q->arrival, &now));
+  }
+  statQueries += pending.size();
+  statBatches++;
+
+  std::vector<int> touched;
+  for (size_t i = 0; i < pending.size(); i++)
+    if (pending[i].fd >= 0)
+      touched.push_back(pending[i].fd);
+  std::sort(touched.begin(), touched.end());
+  touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+  pending.clear();
+  for (size_t i = 0; i < touched.size(); i++)
+    if (clients.count(touched[i]))
+      flushClient(touched[i]);
+}
+
+// Queue an answer of error for a client.
+static void
+queueError(int fd, const struct timespec &now) {
+  Query q = {};
+  q.fd = fd;
+  q.valid = false;
+  q.arrival = now;
+  pending.push_back(q);
+}
+
+// Queue the complete lines a client has sent.  A line longer than MAX_LINE is
+// answered with an error as soon as it is seen to be, and the rest of it is
+// discarded.
+static void
+takeLines(int fd, Client &c, const struct timespec &now) {
+  size_t start = 0, end;
+
+  while ((end = c.in.find('\n', start)) != std::string::npos) {
+    if (c.skipping || end - start > MAX_LINE) {
+      if (!c.skipping)
+	queueError(fd, now);
+      c.skipping = false;
+      start = end + 1;
+      continue;
+    }
+    Query q;
+    long t = 0;
+    std::string line = c.in.substr(start, end - start);
+    q.valid = sscanf(line.c_str(), "%lf %lf %ld", &q.latitude, &q.longitude, &t) == 3;
+    q.fd = fd;
+    q.t = t;
+    q.arrival = now;
+    pending.push_back(q);
+    start = end + 1;
+  }
+  c.in.erase(0, start);
+  if (c.in.size() > MAX_LINE) {
+    if (!c.skipping)
+      queueError(fd, now);
+    c.skipping = true;
+    c.in.clear();
+  }
+}
+
+// Read queries from a client.  Lines that are not queries are queued too, to
+// be answered with an error in their turn.  At the end of the client's
+// input, a last line without a newline is taken as a query, and the client
+// is closed once its queries are answered.  Returns false if the connection
+// has failed.
+static bool
+readClient(int fd) {
+  Client &c = clients[fd];
+  char buf[4096];
+  ssize_t n;
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  while ((n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+    c.in.append(buf, n);
+    takeLines(fd, c, now);
+  }
+  if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+    return(false);
+  if (n == 0) {
+    c.readClosed = true;
+    if (!c.in.empty()) {
+      c.in += '\n';
+      takeLines(fd, c, now);
+    }
+    flushClient(fd);
+  }
+  return(true);
+}
+
+static int
+listenSocket(const char *path) {
+  struct sockaddr_un addr;
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+
+  if (fd < 0)
+    return(-1);
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  unlink(path);
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 128) < 0) {
+    close(fd);
+    return(-1);
+  }
+  return(fd);
+}
+
+static void
+armTimer(int tfd, long us, long interval) {
+  struct itimerspec its;
+  memset(&its, 0, sizeof(its));
+  its.it_value.tv_sec = us / 1000000;
+  its.it_value.tv_nsec = (us % 1000000) * 1000;
+  its.it_interval.tv_sec = interval;
+  timerfd_settime(tfd, 0, &its, NULL);
+}
+
+int
+main(int argc, char *argv[]) {
+  if (argc < 2 || argc > 4) {
+    fprintf(stderr, "usage: %s socket-path [budget-microseconds [max-batch]]\n", argv[0]);
+    return(1);
+  }
+  long budget = argc > 2 ? atol(argv[2]) : 1000;
+  size_t maxBatch = argc > 3 ? atol(argv[3]) : 1024;
+
+  int lfd = listenSocket(argv[1]);
+  if (lfd < 0) {
+    fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+    return(1);
+  }
+  int batchTimer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  int statsTimer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  efd = epoll_create1(EPOLL_CLOEXEC);
+
+  struct epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.fd = lfd;
+  epoll_ctl(efd, EPOLL_CTL_ADD, lfd, &ev);
+  ev.data.fd = batchTimer;
+  epoll_ctl(efd, EPOLL_CTL_ADD, batchTimer, &ev);
+  ev.data.fd = statsTimer;
+  epoll_ctl(efd, EPOLL_CTL_ADD, statsTimer, &ev);
+  armTimer(statsTimer, STATS_INTERVAL * 1000000L, STATS_INTERVAL);
+  signal(SIGPIPE, SIG_IGN);
+
+  for (;;) {
+    struct epoll_event events[64];
+    int n = epoll_wait(efd, events, 64, -1);
+
+    if (n < 0 && errno != EINTR)
+      break;
+    for (int i = 0; i < n; i++) {
+      int fd = events[i].data.fd;
+      uint64_t expirations;
+
+      if (fd == lfd) {
+	int cfd;
+	while ((cfd = accept4(lfd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK)) >= 0) {
+	  clients[cfd].watched = true;
+	  ev.events = EPOLLIN;
+	  ev.data.fd = cfd;
+	  epoll_ctl(efd, EPOLL_CTL_ADD, cfd, &ev);
+	}
+      } else if (fd == batchTimer) {
+	if (read(fd, &expirations, sizeof(expirations)) > 0)
+	  runBatch();
+      } else if (fd == statsTimer) {
+	if (read(fd, &expirations, sizeof(expirations)) > 0)
+	  reportStats();
+      } else if (clients.count(fd)) {
+	// Once a client's input has ended, only its output is of interest.
+	if ((events[i].events & EPOLLOUT) ||
+	    (clients[fd].readClosed && (events[i].events & (EPOLLHUP | EPOLLERR))))
+	  flushClient(fd);
+	if (clients.count(fd) && !clients[fd].readClosed &&
+	    (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+	  bool wasEmpty = pending.empty();
+	  if (!readClient(fd)) {
+	    closeClient(fd);
+	    continue;
+	  }
+	  // The first query of a batch starts the clock on the time budget.
+	  if (pending.size() >= maxBatch) {
+	    armTimer(batchTimer, 0, 0);
+	    runBatch();
+	  } else if (wasEmpty && !pending.empty())
+	    armTimer(batchTimer, budget > 0 ? budget : 1, 0);
+	}
+      }
+    }
+  }
+  return(1);
+}
@@ -0,0 +1,208 @@
+/*
+ * Find the cheapest search window, step, points and ephemeris that meet an
+ * accuracy target for a set of sites.
+ *
+ * Usage: sunriseTune [-h] sites-file target-seconds [hours [year]]
+ *
+ * The sites file holds one "latitude longitude" pair per line, in decimal
+ * degrees.  Each site is queried at random times through the year (default
+ * 2025), and every combination of window, step, number of interpolated points
+ * and ephemeris is compared with a reference search using a 48 hour window,
+ * ten minute steps and three points.  Only
+ * events within the given number of hours of the query time (default 12) are
+ * compared; the application is taken not to need more distant ones.  An
+ * event that a combination misses, adds, or places more than an hour away
+ * from the reference's is counted as missed.
+ *
+ * The report lists each combination's cost per query, largest error and
+ * missed events, cheapest first, and marks the cheapest with no missed events
+ * and no error above the target.  With -h, a configuration header for that
+ * combination is written instead; compile the library with it included first
+ * (e.g. with "-include sunriseConfig.h").
+ *
+ * Build:  g++ -O2 -std=c++14 -I.. sunriseTune.cpp ../SunRise.cpp ../SunRiseAnnual.cpp
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+
+#include "SunRiseKernel.h"
+#include "SunRiseAnnual.h"
+
+#define QUERIES_PER_SITE    200
+#define WRONG_EVENT	    3600	    // Seconds
+
+typedef void (*Engine)(SunRise *sr, double latitude, double longitude, time_t t);
+
+template <class Ephemeris, int Window, int Step, int Points>
+static void
+search(SunRise *sr, double latitude, double longitude, time_t t) {
+  SunRiseKernel<SunRiseLibMath, Ephemeris, SunRiseGrid<Window, Step, Points> >::calculate(
+    sr, latitude, longitude, t);
+}
+
+struct Candidate {
+  const char *ephemeris;
+  int window;		    // Hours
+  int step;		    // Minutes
+  int points;
+  Engine engine;
+  double cost;		    // Nanoseconds per query
+  double worst;		    // Seconds
+  long missed;
+};
+
+#define SERIES(w, s, p)	{ "series", w, s, p, search<SunRiseSeries<SunRiseLibMath>, w, s, p>, \
+			  0, 0, 0 }
+#define ANNUAL(w, s, p)	{ "annual", w, s, p, search<SunRiseAnnualEphemeris, w, s, p>, 0, 0, 0 }
+#define POINTS(w, p)	SERIES(w, 30, p), SERIES(w, 60, p), SERIES(w, 120, p), \
+			ANNUAL(w, 30, p), ANNUAL(w, 60, p), ANNUAL(w, 120, p)
+#define WINDOW(w)	POINTS(w, 2), POINTS(w, 3), POINTS(w, 5)
+
+static Candidate candidates[] = { WINDOW(12), WINDOW(24), WINDOW(36), WINDOW(48) };
+#define CANDIDATES (int)(sizeof(candidates) / sizeof(candidates[0]))
+
+static Engine reference = search<SunRiseSeries<SunRiseLibMath>, 48, 10, 3>;
+
+struct Query {
+  double latitude, longitude;
+  time_t t;
+};
+
+static double
+now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+// Compare one kind of event.  Returns the error in seconds, or -1 if the
+// event is missed, added, or misplaced.
+static double
+compare(bool refHas, time_t refTime, bool has, time_t eventTime, time_t t, long range) {
+  bool needed = refHas && labs((long)(refTime - t)) <= range;
+  bool found = has && labs((long)(eventTime - t)) <= range;
+  bool same = refHas && has && labs((long)(eventTime - refTime)) <= WRONG_EVENT;
+
+  if (!needed && !found)
+    return(0);
+  if (!same)
+    return(-1);
+  return(labs((long)(eventTime - refTime)));
+}
+
+static void
+usage() {
+  fprintf(stderr, "usage: sunriseTune [-h] sites-file target-seconds [hours [year]]\n");
+  exit(2);
+}
+
+int
+main(int argc, char *argv[]) {
+  bool header = argc > 1 && strcmp(argv[1], "-h") == 0;
+  if (header) {
+    argc--;
+    argv++;
+  }
+  if (argc < 3)
+    usage();
+
+  double target = atof(argv[2]);
+  long range = (long)((argc > 3 ? atof(argv[3]) : 12) * 3600);
+  int year = argc > 4 ? atoi(argv[4]) : 2025;
+
+  FILE *f = fopen(argv[1], "r");
+  if (f == NULL) {
+    perror(argv[1]);
+    return(1);
+  }
+  std::vector<Query> queries;
+  double latitude, longitude;
+  time_t start = (time_t)((year - 1970) * 365.2425 * 86400);
+  srand48(1);
+  while (fscanf(f, "%lf %lf", &latitude, &longitude) == 2) {
+    for (int i = 0; i < QUERIES_PER_SITE; i++) {
+      Query q = { latitude, longitude, start + (time_t)(drand48() * 365 * 86400) };
+      queries.push_back(q);
+    }
+  }
+  fclose(f);
+  if (queries.empty())
+    usage();
+
+  std::vector<SunRise> expected(queries.size()), results(queries.size());
+  for (size_t i = 0; i < queries.size(); i++)
+    reference(&expected[i], queries[i].latitude, queries[i].longitude, queries[i].t);
+
+  for (int c = 0; c < CANDIDATES; c++) {
+    Candidate &cand = candidates[c];
+
+    // The fastest of a few runs, to reduce the effect of other activity.
+    cand.cost = HUGE_VAL;
+    for (int run = 0; run < 3; run++) {
+      double begin = now();
+      for (size_t i = 0; i < queries.size(); i++)
+	cand.engine(&results[i], queries[i].latitude, queries[i].longitude, queries[i].t);
+      cand.cost = std::min(cand.cost, (now() - begin) / queries.size() * 1e9);
+    }
+    cand.worst = 0;
+    cand.missed = 0;
+
+    for (size_t i = 0; i < queries.size(); i++) {
+      const SunRise &a = expected[i], &b = results[i];
+      double e[2] = {
+	compare(a.hasRise, a.riseTime, b.hasRise, b.riseTime, a.queryTime, range),
+	compare(a.hasSet, a.setTime, b.hasSet, b.setTime, a.queryTime, range)
+      };
+      for (int j = 0; j < 2; j++) {
+	if (e[j] < 0)
+	  cand.missed++;
+	else
+	  cand.worst = std::max(cand.worst, e[j]);
+      }
+    }
+  }
+
+  std::sort(candidates, candidates + CANDIDATES,
+	    [](const Candidate &a, const Candidate &b) { return(a.cost < b.cost); });
+  int best = -1;
+  for (int c = 0; c < CANDIDATES && best < 0; c++)
+    if (candidates[c].missed == 0 && candidates[c].worst <= target)
+      best = c;
+
+  if (header) {
+    if (best < 0) {
+      fprintf(stderr, "no combination meets the target\n");
+      return(1);
+    }
+    const Candidate &b = candidates[best];
+    printf("// SunRise configuration generated by sunriseTune for %s:\n"
+	   "// %zu queries, events within %g hours, error at most %g seconds.\n"
+	   "// Largest error found %g seconds.  Use %s.\n\n"
+	   "#define SR_WINDOW   %d\n"
+	   "#define SR_STEP	    %d\n"
+	   "#define SR_POINTS   %d\n",
+	   argv[1], queries.size(), range / 3600.0, target, b.worst,
+	   strcmp(b.ephemeris, "annual") == 0 ? "SunRiseAnnual" : "SunRise",
+	   b.window, b.step, b.points);
+    return(0);
+  }
+
+  printf("%zu queries, events within %g hours, target %g seconds\n\n",
+	 queries.size(), range / 3600.0, target);
+  printf("  ephemeris window  step    points      cost   max error  missed\n");
+  for (int c = 0; c < CANDIDATES; c++) {
+    const Candidate &cand = candidates[c];
+    printf("%c %-9s %4d h %3d min %6d %8.0f ns %9.0f s %7ld\n", c == best ? '*' : ' ',
+	   cand.ephemeris, cand.window, cand.step, cand.points, cand.cost, cand.worst,
+	   cand.missed);
+  }
+  if (best < 0)
+    printf("\nNo combination meets the target.\n");
+  return(best < 0);
+}